@@ -0,0 +1,13 @@
+#include "DidYouKnow/CreateContainerInstantiations.hpp"
+
+/**
+ * Defines the instantiations that DidYouKnow/CreateContainerInstantiations.hpp
+ * declares extern, for builds with DIDYOUKNOW_EXTERN_TEMPLATES
+ */
+namespace DidYouKnow
+{
+template class CreateContainer<std::vector, int>;
+template class CreateContainer<std::list, std::string>;
+template class CreateContainer<std::vector, const char *>;
+template class CreateContainer<std::vector, Test>;
+} // namespace DidYouKnow
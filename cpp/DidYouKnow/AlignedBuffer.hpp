@@ -0,0 +1,534 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DIDYOUKNOW_X86
+#endif
+
+namespace DidYouKnow
+{
+/**
+ * A fixed number of elements, aligned to Align bytes, and padded with
+ * zeroes to a whole number of Align-byte vectors, so a kernel can load
+ * and store whole vectors, aligned, to the end, without a loop for the
+ * remainder.  Large buffers have a mapping of their own, aligned to and
+ * advised to use huge pages, which also arrives already zeroed.  Indexing
+ * is checked only in builds without NDEBUG.
+ */
+template <typename T, size_t Align = 64>
+class AlignedBuffer
+{
+    static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0, "Align must be a power of two, at least the type's own");
+    static_assert(std::is_trivial<T>::value, "Elements are zeroed and copied as raw memory");
+
+    static const size_t HugePage = 2 << 20;
+
+    T *_data;
+    size_t _size;
+    size_t _capacity;
+    bool _mapped;
+
+    static size_t padded(const size_t size)
+    {
+        const size_t lanes = Align >= sizeof(T) ? Align / sizeof(T) : 1;
+        return (size + lanes - 1) / lanes * lanes;
+    }
+
+    static size_t mappedBytes(const size_t bytes)
+    {
+        return (bytes + HugePage - 1) / HugePage * HugePage;
+    }
+
+    void allocate()
+    {
+        const size_t bytes = _capacity * sizeof(T);
+
+        if (bytes == 0)
+        {
+            return;
+        }
+
+#ifdef __linux__
+        if (bytes >= HugePage && Align <= HugePage)
+        {
+            // Over-map by a huge page, then trim either end, to start on one
+            const size_t length = mappedBytes(bytes);
+            void *const mapped = mmap(nullptr, length + HugePage, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (mapped != MAP_FAILED)
+            {
+                char *const start = static_cast<char *>(mapped);
+                char *const aligned = start + (HugePage - reinterpret_cast<uintptr_t>(start) % HugePage) % HugePage;
+
+                if (aligned != start)
+                {
+                    munmap(start, aligned - start);
+                }
+
+                munmap(aligned + length, start + HugePage - aligned);
+                madvise(aligned, length, MADV_HUGEPAGE);
+                _data = reinterpret_cast<T *>(aligned);
+                _mapped = true;
+                return;
+            }
+        }
+#endif
+
+        _data = static_cast<T *>(::operator new(bytes, std::align_val_t(Align)));
+        std::memset(static_cast<void *>(_data), 0, bytes);
+    }
+
+    void release()
+    {
+#ifdef __linux__
+        if (_mapped)
+        {
+            munmap(_data, mappedBytes(_capacity * sizeof(T)));
+            return;
+        }
+#endif
+
+        if (_data)
+        {
+            ::operator delete(_data, std::align_val_t(Align));
+        }
+    }
+
+    void check(const size_t index) const
+    {
+        if (index >= _size)
+        {
+            throw std::out_of_range("Index " + std::to_string(index) + " is beyond an AlignedBuffer of " +
+                                    std::to_string(_size));
+        }
+    }
+
+  public:
+    explicit AlignedBuffer(const size_t size = 0)
+        : _data(nullptr), _size(size), _capacity(padded(size)), _mapped(false)
+    {
+        allocate();
+    }
+
+    AlignedBuffer(const size_t size, const T &value) : AlignedBuffer(size)
+    {
+        for (size_t i = 0; i < _size; ++i)
+        {
+            _data[i] = value;
+        }
+    }
+
+    AlignedBuffer(const std::initializer_list<T> values) : AlignedBuffer(values.size())
+    {
+        std::memcpy(static_cast<void *>(_data), values.begin(), values.size() * sizeof(T));
+    }
+
+    AlignedBuffer(const AlignedBuffer &other) : AlignedBuffer(other._size)
+    {
+        std::memcpy(static_cast<void *>(_data), other._data, _capacity * sizeof(T));
+    }
+
+    AlignedBuffer(AlignedBuffer &&other) noexcept
+        : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)),
+          _capacity(std::exchange(other._capacity, 0)), _mapped(std::exchange(other._mapped, false))
+    {
+    }
+
+    AlignedBuffer &operator=(AlignedBuffer other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~AlignedBuffer()
+    {
+        release();
+    }
+
+    void swap(AlignedBuffer &other) noexcept
+    {
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_mapped, other._mapped);
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * The elements allocated, padding included, which kernels may read and
+     * write, but indexing may not
+     */
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    /**
+     * Whether the elements have a mapping of their own, advised to use
+     * huge pages, which the kernel grants as it sees fit
+     */
+    bool mapped() const
+    {
+        return _mapped;
+    }
+
+    T *data()
+    {
+        return static_cast<T *>(__builtin_assume_aligned(_data, Align));
+    }
+
+    const T *data() const
+    {
+        return static_cast<const T *>(__builtin_assume_aligned(_data, Align));
+    }
+
+    T *begin()
+    {
+        return data();
+    }
+
+    T *end()
+    {
+        return data() + _size;
+    }
+
+    const T *begin() const
+    {
+        return data();
+    }
+
+    const T *end() const
+    {
+        return data() + _size;
+    }
+
+    T &operator[](const size_t index)
+    {
+#ifndef NDEBUG
+        check(index);
+#endif
+        return _data[index];
+    }
+
+    const T &operator[](const size_t index) const
+    {
+#ifndef NDEBUG
+        check(index);
+#endif
+        return _data[index];
+    }
+};
+
+typedef AlignedBuffer<float> FloatBuffer;
+typedef AlignedBuffer<int32_t> IndexBuffer;
+
+/**
+ * The instruction sets the kernels below are written for, in increasing
+ * order of width
+ */
+enum class SimdLevel
+{
+    Scalar,
+    Sse,
+    Avx2
+};
+
+inline const char *simdName(const SimdLevel level)
+{
+    return level == SimdLevel::Avx2 ? "AVX2" : level == SimdLevel::Sse ? "SSE"
+                                                                       : "scalar";
+}
+
+/**
+ * The widest instruction set this processor supports, asked of it once
+ */
+inline SimdLevel bestSimd()
+{
+#ifdef DIDYOUKNOW_X86
+    static const SimdLevel best = []()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? SimdLevel::Avx2
+               : __builtin_cpu_supports("sse2")                              ? SimdLevel::Sse
+                                                                             : SimdLevel::Scalar;
+    }();
+
+    return best;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+/**
+ * One implementation of each kernel, for one instruction set.  All but
+ * gather work in whole vectors, through the padding beyond count, so
+ * expect aligned, padded buffers.  Gather finishes its last vector one
+ * element at a time, as the padding of a buffer of indexes need not hold
+ * indexes that can be read.
+ */
+struct SimdKernels
+{
+    void (*add)(const float *a, const float *b, float *out, size_t count);
+    void (*scale)(const float *a, float factor, float *out, size_t count);
+    void (*multiplyAdd)(const float *a, const float *b, const float *c, float *out, size_t count);
+    void (*greater)(const float *a, const float *b, int32_t *out, size_t count);
+    void (*gather)(const float *a, const int32_t *indexes, float *out, size_t count);
+};
+
+inline void scalarAdd(const float *a, const float *b, float *out, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[i] + b[i];
+    }
+}
+
+inline void scalarScale(const float *a, const float factor, float *out, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[i] * factor;
+    }
+}
+
+inline void scalarMultiplyAdd(const float *a, const float *b, const float *c, float *out, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[i] * b[i] + c[i];
+    }
+}
+
+inline void scalarGreater(const float *a, const float *b, int32_t *out, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[i] > b[i];
+    }
+}
+
+inline void scalarGather(const float *a, const int32_t *indexes, float *out, const size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        out[i] = a[indexes[i]];
+    }
+}
+
+#ifdef DIDYOUKNOW_X86
+__attribute__((target("sse2"))) inline void sseAdd(const float *a, const float *b, float *out, const size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        _mm_store_ps(out + i, _mm_add_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+    }
+}
+
+__attribute__((target("sse2"))) inline void sseScale(const float *a, const float factor, float *out, const size_t count)
+{
+    const __m128 factors = _mm_set1_ps(factor);
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        _mm_store_ps(out + i, _mm_mul_ps(_mm_load_ps(a + i), factors));
+    }
+}
+
+/**
+ * SSE has no fused multiply-add, so rounds twice
+ */
+__attribute__((target("sse2"))) inline void sseMultiplyAdd(const float *a, const float *b, const float *c, float *out,
+                                                            const size_t count)
+{
+    for (size_t i = 0; i < count; i += 4)
+    {
+        _mm_store_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)), _mm_load_ps(c + i)));
+    }
+}
+
+__attribute__((target("sse2"))) inline void sseGreater(const float *a, const float *b, int32_t *out, const size_t count)
+{
+    const __m128i ones = _mm_set1_epi32(1);
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        const __m128 mask = _mm_cmpgt_ps(_mm_load_ps(a + i), _mm_load_ps(b + i));
+        _mm_store_si128(reinterpret_cast<__m128i *>(out + i), _mm_and_si128(_mm_castps_si128(mask), ones));
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline void avx2Add(const float *a, const float *b, float *out, const size_t count)
+{
+    for (size_t i = 0; i < count; i += 8)
+    {
+        _mm256_store_ps(out + i, _mm256_add_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline void avx2Scale(const float *a, const float factor, float *out, const size_t count)
+{
+    const __m256 factors = _mm256_set1_ps(factor);
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        _mm256_store_ps(out + i, _mm256_mul_ps(_mm256_load_ps(a + i), factors));
+    }
+}
+
+/**
+ * Fused, so rounds once, and may differ from the other kernels in the last
+ * place
+ */
+__attribute__((target("avx2,fma"))) inline void avx2MultiplyAdd(const float *a, const float *b, const float *c, float *out,
+                                                                 const size_t count)
+{
+    for (size_t i = 0; i < count; i += 8)
+    {
+        _mm256_store_ps(out + i, _mm256_fmadd_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i), _mm256_load_ps(c + i)));
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline void avx2Greater(const float *a, const float *b, int32_t *out, const size_t count)
+{
+    const __m256i ones = _mm256_set1_epi32(1);
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        const __m256 mask = _mm256_cmp_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i), _CMP_GT_OQ);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(out + i), _mm256_and_si256(_mm256_castps_si256(mask), ones));
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline void avx2Gather(const float *a, const int32_t *indexes, float *out,
+                                                            const size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i vector = _mm256_load_si256(reinterpret_cast<const __m256i *>(indexes + i));
+        _mm256_store_ps(out + i, _mm256_i32gather_ps(a, vector, sizeof(float)));
+    }
+
+    scalarGather(a, indexes + i, out + i, count - i);
+}
+#endif
+
+/**
+ * The kernels for an instruction set, which must be one this processor
+ * supports
+ */
+inline const SimdKernels &simdKernels(const SimdLevel level = bestSimd())
+{
+    static const SimdKernels scalar = {scalarAdd, scalarScale, scalarMultiplyAdd, scalarGreater, scalarGather};
+
+    if (level > bestSimd())
+    {
+        throw std::invalid_argument(std::string("This processor does not support ") + simdName(level));
+    }
+
+#ifdef DIDYOUKNOW_X86
+    // SSE has no gather instruction
+    static const SimdKernels sse = {sseAdd, sseScale, sseMultiplyAdd, sseGreater, scalarGather};
+    static const SimdKernels avx2 = {avx2Add, avx2Scale, avx2MultiplyAdd, avx2Greater, avx2Gather};
+
+    return level == SimdLevel::Avx2 ? avx2 : level == SimdLevel::Sse ? sse
+                                                                     : scalar;
+#else
+    return scalar;
+#endif
+}
+
+inline void requireSameSize(const size_t size, const size_t other)
+{
+    if (size != other)
+    {
+        throw std::invalid_argument("Buffers of " + std::to_string(size) + " and " + std::to_string(other) +
+                                    " elements cannot be combined element-wise");
+    }
+}
+
+/**
+ * out = a + b, element-wise, where out may be either of them
+ */
+inline void add(const FloatBuffer &a, const FloatBuffer &b, FloatBuffer &out, const SimdLevel level = bestSimd())
+{
+    requireSameSize(a.size(), b.size());
+    requireSameSize(a.size(), out.size());
+    simdKernels(level).add(a.data(), b.data(), out.data(), a.size());
+}
+
+inline void scale(const FloatBuffer &a, const float factor, FloatBuffer &out, const SimdLevel level = bestSimd())
+{
+    requireSameSize(a.size(), out.size());
+    simdKernels(level).scale(a.data(), factor, out.data(), a.size());
+}
+
+/**
+ * out = a * b + c, element-wise, rounded once where the processor can
+ * fuse the two, and twice where it cannot
+ */
+inline void multiplyAdd(const FloatBuffer &a, const FloatBuffer &b, const FloatBuffer &c, FloatBuffer &out,
+                        const SimdLevel level = bestSimd())
+{
+    requireSameSize(a.size(), b.size());
+    requireSameSize(a.size(), c.size());
+    requireSameSize(a.size(), out.size());
+    simdKernels(level).multiplyAdd(a.data(), b.data(), c.data(), out.data(), a.size());
+}
+
+/**
+ * out = a > b, element-wise, as 1 or 0
+ */
+inline void greater(const FloatBuffer &a, const FloatBuffer &b, IndexBuffer &out, const SimdLevel level = bestSimd())
+{
+    requireSameSize(a.size(), b.size());
+    requireSameSize(a.size(), out.size());
+    simdKernels(level).greater(a.data(), b.data(), out.data(), a.size());
+}
+
+/**
+ * out[i] = a[indexes[i]], where every index must be within a, which only
+ * builds without NDEBUG check
+ */
+inline void gather(const FloatBuffer &a, const IndexBuffer &indexes, FloatBuffer &out, const SimdLevel level = bestSimd())
+{
+    requireSameSize(indexes.size(), out.size());
+
+#ifndef NDEBUG
+    for (const int32_t index : indexes)
+    {
+        if (index < 0 || static_cast<size_t>(index) >= a.size())
+        {
+            throw std::out_of_range("Cannot gather index " + std::to_string(index) + " from a buffer of " +
+                                    std::to_string(a.size()));
+        }
+    }
+#endif
+
+    simdKernels(level).gather(a.data(), indexes.data(), out.data(), indexes.size());
+}
+} // namespace DidYouKnow
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "Timing.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * Convinces the optimiser that a value is used, so the work that produced
+ * it cannot be thrown away, without costing anything at runtime
+ */
+template <typename T>
+inline void doNotOptimise(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline void clobberMemory()
+{
+    asm volatile("" : : : "memory");
+}
+
+/**
+ * Collects benchmark measurements as rows of labels and metrics, printing
+ * each to the console as soon as it is measured, and optionally saving
+ * them all as CSV
+ */
+class BenchmarkTable
+{
+    std::vector<std::string> _labels;
+    std::vector<std::string> _metrics;
+    std::vector<std::vector<std::string>> _rows;
+    size_t _repetitions;
+
+    static size_t width(const std::string &heading)
+    {
+        return std::max<size_t>(14, heading.size() + 2);
+    }
+
+    void printRow(const std::vector<std::string> &cells) const
+    {
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            const std::string &heading = i < _labels.size() ? _labels[i] : _metrics[i - _labels.size()];
+            const size_t columnWidth = width(heading);
+            std::cout << std::left << std::setw(static_cast<int>(columnWidth)) << cells[i]
+                      << (cells[i].size() >= columnWidth ? " " : "");
+        }
+
+        std::cout << std::endl;
+    }
+
+  public:
+    BenchmarkTable(const std::vector<std::string> &labels, const std::vector<std::string> &metrics = {"ns/op"})
+        : _labels(labels), _metrics(metrics), _repetitions(5)
+    {
+        std::vector<std::string> headings(_labels);
+        headings.insert(headings.end(), _metrics.begin(), _metrics.end());
+        printRow(headings);
+    }
+
+    void setRepetitions(const size_t repetitions)
+    {
+        _repetitions = std::max<size_t>(1, repetitions);
+    }
+
+    void add(const std::vector<std::string> &labels, const std::vector<double> &metrics)
+    {
+        std::vector<std::string> cells(labels);
+
+        for (const double metric : metrics)
+        {
+            std::ostringstream formatted;
+            formatted << std::setprecision(4) << metric;
+            cells.push_back(formatted.str());
+        }
+
+        printRow(cells);
+        _rows.push_back(cells);
+    }
+
+    /**
+     * Times a number of iterations of a body, after one to warm up,
+     * returning the median of several repetitions, in nanoseconds per iteration
+     */
+    template <typename Body>
+    double time(const size_t iterations, Body body) const
+    {
+        body();
+        std::vector<double> perIteration;
+
+        for (size_t repetition = 0; repetition < _repetitions; ++repetition)
+        {
+            const Stopwatch::time_point started = Stopwatch::now();
+
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                body();
+            }
+
+            perIteration.push_back(nanosecondsSince(started) / iterations);
+        }
+
+        return median(perIteration);
+    }
+
+    template <typename Body>
+    double measure(const std::vector<std::string> &labels, const size_t iterations, Body body)
+    {
+        const double nanoseconds = time(iterations, body);
+        add(labels, {nanoseconds});
+        return nanoseconds;
+    }
+
+    bool writeCsv(const std::string &path) const
+    {
+        std::ofstream file(path.c_str());
+        std::vector<std::string> headings(_labels);
+        headings.insert(headings.end(), _metrics.begin(), _metrics.end());
+
+        for (size_t i = 0; i < headings.size(); ++i)
+        {
+            file << (i ? "," : "") << headings[i];
+        }
+
+        file << '\n';
+
+        for (const std::vector<std::string> &row : _rows)
+        {
+            for (size_t i = 0; i < row.size(); ++i)
+            {
+                file << (i ? "," : "") << row[i];
+            }
+
+            file << '\n';
+        }
+
+        return static_cast<bool>(file);
+    }
+};
+
+/**
+ * Finds the value of an option such as --csv, in the arguments passed
+ * to a benchmark, or returns the fallback when it was not given
+ */
+inline std::string benchmarkOption(const int argc, char *argv[], const char *option, const std::string &fallback = "")
+{
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], option) == 0)
+        {
+            return argv[i + 1];
+        }
+    }
+
+    return fallback;
+}
+} // namespace DidYouKnow
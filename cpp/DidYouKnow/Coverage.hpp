@@ -0,0 +1,317 @@
+#pragma once
+
+#include "Profiler.hpp"
+#include "Test.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * Records which functions each test enters, in builds compiled with
+ * -finstrument-functions and DIDYOUKNOW_COVERAGE, where the compiler calls
+ * a hook on entry to every function.  Entries are attributed to whichever
+ * test the runner has tagged, and those made while the EventLoop runs to
+ * every asynchronous test, as they are all in flight together.
+ */
+class Coverage
+{
+    static inline std::mutex _mutex;
+
+    __attribute__((no_instrument_function)) static std::set<std::pair<int, void *>> &entered()
+    {
+        static std::set<std::pair<int, void *>> *entered = new std::set<std::pair<int, void *>>();
+        return *entered;
+    }
+
+    /**
+     * Where a function is in the source, from its debug information
+     */
+    struct Location
+    {
+        int first;
+        int last;
+        std::string file;
+    };
+
+    /**
+     * The lines a command writes, without their line breaks
+     */
+    static std::vector<std::string> outputOf(const std::string &command)
+    {
+        std::vector<std::string> lines;
+        FILE *output = popen(command.c_str(), "r");
+
+        if (!output)
+        {
+            return lines;
+        }
+
+        char line[4096];
+
+        while (fgets(line, sizeof(line), output))
+        {
+            lines.emplace_back(line, std::strcspn(line, "\n"));
+        }
+
+        pclose(output);
+        return lines;
+    }
+
+    /**
+     * The first and last lines of each function with a known size: the
+     * first where it starts, from addr2line, and the last the furthest line
+     * of the same file that any of its instructions came from, from the
+     * line table.  Functions of unknown size are left out, so changes to
+     * them are treated as outside every function.
+     */
+    static std::map<void *, Location> locate(const std::set<void *> &functions)
+    {
+        std::map<void *, Location> locations;
+        char executable[4096] = {};
+
+        if (readlink("/proc/self/exe", executable, sizeof(executable) - 1) <= 0)
+        {
+            return locations;
+        }
+
+        // Addresses as the tools see them, relative to where a PIE was loaded
+        std::map<void *, size_t> addresses;
+
+        for (void *function : functions)
+        {
+            Dl_info info;
+            const char *base = dladdr(function, &info) ? static_cast<const char *>(info.dli_fbase) : nullptr;
+#ifdef __PIE__
+            addresses[function] = static_cast<size_t>(static_cast<const char *>(function) - base);
+#else
+            static_cast<void>(base);
+            addresses[function] = reinterpret_cast<size_t>(function);
+#endif
+        }
+
+        std::map<size_t, size_t> sizes;
+
+        for (const std::string &symbol : outputOf("nm -S --defined-only '" + std::string(executable) + "'"))
+        {
+            unsigned long address = 0, size = 0;
+            char type = 0;
+
+            if (std::sscanf(symbol.c_str(), "%lx %lx %c", &address, &size, &type) == 3 && size &&
+                std::strchr("tTwW", type))
+            {
+                sizes[address] = size;
+            }
+        }
+
+        // Each row of the line table, as address, line, and the file it belongs to
+        std::vector<std::string> files;
+        std::vector<std::tuple<size_t, int, size_t>> rows;
+
+        for (const std::string &row : outputOf("objdump --dwarf=decodedline '" + std::string(executable) + "'"))
+        {
+            const size_t address = row.find(" 0x");
+
+            if (address == std::string::npos)
+            {
+                if (!row.empty() && row.back() == ':')
+                {
+                    const size_t from = row.rfind("CU: ", 0) == 0 ? 4 : 0;
+                    files.push_back(row.substr(from, row.size() - 1 - from));
+                }
+
+                continue;
+            }
+
+            const size_t number = row.find_last_of(' ', row.find_last_not_of(' ', address));
+            const int line = std::atoi(row.c_str() + (number == std::string::npos ? 0 : number + 1));
+
+            if (line > 0 && !files.empty())
+            {
+                rows.emplace_back(std::strtoull(row.c_str() + address + 3, nullptr, 16), line, files.size() - 1);
+            }
+        }
+
+        std::sort(rows.begin(), rows.end());
+        std::ostringstream command;
+        command << "addr2line -e '" << executable << "'" << std::hex;
+        std::vector<void *> ordered;
+
+        for (const std::pair<void *const, size_t> &address : addresses)
+        {
+            if (sizes.count(address.second))
+            {
+                command << ' ' << address.second;
+                ordered.push_back(address.first);
+            }
+        }
+
+        const std::vector<std::string> starts = outputOf(command.str());
+
+        for (size_t i = 0; i < ordered.size() && i < starts.size(); ++i)
+        {
+            const std::string &start = starts[i];
+            const size_t colon = start.rfind(':');
+
+            if (start.empty() || start[0] == '?' || colon == std::string::npos || std::atoi(start.c_str() + colon + 1) <= 0)
+            {
+                continue;
+            }
+
+            Location location{std::atoi(start.c_str() + colon + 1), 0, start.substr(0, colon)};
+            location.last = location.first;
+            const size_t address = addresses.at(ordered[i]);
+            const size_t end = address + sizes.at(address);
+
+            for (auto row = std::lower_bound(rows.begin(), rows.end(), std::make_tuple(address, 0, size_t(0)));
+                 row != rows.end() && std::get<0>(*row) < end; ++row)
+            {
+                const std::string &file = files[std::get<2>(*row)];
+
+                if (location.file == file ||
+                    (location.file.size() > file.size() && location.file.compare(location.file.size() - file.size() - 1, std::string::npos, "/" + file) == 0))
+                {
+                    location.first = std::min(location.first, std::get<1>(*row));
+                    location.last = std::max(location.last, std::get<1>(*row));
+                }
+            }
+
+            locations[ordered[i]] = location;
+        }
+
+        return locations;
+    }
+
+  public:
+    __attribute__((no_instrument_function)) static void enter(void *function)
+    {
+        thread_local bool entering = false;
+
+        if (entering)
+        {
+            return;
+        }
+
+        entering = true;
+        const std::pair<int, void *> entry(Profiler::tagged(), function);
+
+        // Most calls are to functions this thread has recently entered
+        thread_local std::pair<int, void *> recent[1024];
+        std::pair<int, void *> &cached = recent[(reinterpret_cast<size_t>(function) >> 4) % 1024];
+
+        if (cached != entry)
+        {
+            cached = entry;
+            const std::lock_guard<std::mutex> lock(_mutex);
+            entered().insert(entry);
+        }
+
+        entering = false;
+    }
+
+    /**
+     * Writes the index used by --changed-since: a "function <first> <last>
+     * <file>" line for the lines of every function entered, a "test <name>
+     * <first> <file>" line for each function a test entered, and a "main
+     * <first> <last> <file>" line for where the tests are registered.
+     * Returns whether any functions could be located.
+     */
+    static bool write(const std::string &path, const std::vector<Test> &tests)
+    {
+        std::vector<std::pair<int, void *>> entries;
+        std::set<void *> functions;
+
+        {
+            // Copied, as the functions called from here are instrumented too
+            const std::lock_guard<std::mutex> lock(_mutex);
+            entries.assign(entered().begin(), entered().end());
+        }
+
+        for (const std::pair<int, void *> &entry : entries)
+        {
+            functions.insert(entry.second);
+        }
+
+        void *main = dlsym(RTLD_DEFAULT, "main");
+        functions.insert(main);
+
+        const std::map<void *, Location> locations = locate(functions);
+
+        if (locations.empty())
+        {
+            return false;
+        }
+
+        std::set<std::string> lines;
+
+        const auto extent = [](const Location &location)
+        {
+            return std::to_string(location.first) + ' ' + std::to_string(location.last) + ' ' + location.file;
+        };
+
+        if (locations.count(main))
+        {
+            lines.insert("main " + extent(locations.at(main)));
+        }
+
+        for (const auto &location : locations)
+        {
+            lines.insert("function " + extent(location.second));
+        }
+
+        for (const std::pair<int, void *> &entry : entries)
+        {
+            const auto location = locations.find(entry.second);
+
+            if (location == locations.end() || entry.first == Profiler::Runner)
+            {
+                continue;
+            }
+
+            for (size_t i = 0; i < tests.size(); ++i)
+            {
+                if (entry.first == static_cast<int>(i) || (entry.first == Profiler::EventLoop && tests[i].isAsync()))
+                {
+                    lines.insert("test " + std::string(tests[i].name) + ' ' + std::to_string(location->second.first) + ' ' + location->second.file);
+                }
+            }
+        }
+
+        std::ofstream file(path.c_str());
+
+        for (const std::string &line : lines)
+        {
+            file << line << '\n';
+        }
+
+        return static_cast<bool>(file);
+    }
+};
+} // namespace DidYouKnow
+
+#ifdef DIDYOUKNOW_COVERAGE
+/**
+ * The hooks called by -finstrument-functions, so this header must be
+ * included by only one translation unit of a coverage build
+ */
+extern "C" __attribute__((no_instrument_function)) void __cyg_profile_func_enter(void *function, void *)
+{
+    DidYouKnow::Coverage::enter(function);
+}
+
+extern "C" __attribute__((no_instrument_function)) void __cyg_profile_func_exit(void *, void *) {}
+#endif
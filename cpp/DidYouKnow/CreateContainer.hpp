@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+
+namespace DidYouKnow
+{
+/**
+ * Builds any standard-style sequence container, whose type is passed as a
+ * template template parameter, via fluent calls to overloaded operators
+ */
+template <template <class, class> class V, class T>
+class CreateContainer
+{
+  protected:
+    V<T, std::allocator<T>> _container;
+
+  public:
+    CreateContainer &addValue(const T &value)
+    {
+        _container.push_back(value);
+        return *this;
+    }
+
+    CreateContainer() {}
+
+    CreateContainer(const T &value)
+    {
+        addValue(value);
+    }
+
+    CreateContainer &operator,(const T &value)
+    {
+        return addValue(value);
+    }
+
+    CreateContainer &operator()(const T &value)
+    {
+        return addValue(value);
+    }
+
+    V<T, std::allocator<T>> get() const
+    {
+        return _container;
+    }
+};
+} // namespace DidYouKnow
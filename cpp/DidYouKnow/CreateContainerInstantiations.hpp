@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CreateContainer.hpp"
+#include "Test.hpp"
+
+#include <list>
+#include <string>
+#include <vector>
+
+#ifdef DIDYOUKNOW_EXTERN_TEMPLATES
+namespace DidYouKnow
+{
+/**
+ * The instantiations of CreateContainer used most often, which builds that
+ * define DIDYOUKNOW_EXTERN_TEMPLATES compile once, in CreateContainer.cpp,
+ * instead of in every translation unit that uses them
+ */
+extern template class CreateContainer<std::vector, int>;
+extern template class CreateContainer<std::list, std::string>;
+extern template class CreateContainer<std::vector, const char *>;
+extern template class CreateContainer<std::vector, Test>;
+} // namespace DidYouKnow
+#endif
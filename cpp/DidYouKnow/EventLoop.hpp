@@ -0,0 +1,362 @@
+#pragma once
+
+#include "Task.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+namespace DidYouKnow
+{
+/**
+ * A single-threaded event loop that drives Tasks, suspending them while
+ * they wait on file descriptors or timers, so that any number of them
+ * may be in flight at once.  Readiness comes from epoll on Linux,
+ * and from plain old poll everywhere else.
+ */
+class EventLoop
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+  private:
+    struct Watch
+    {
+        std::coroutine_handle<> reader;
+        std::coroutine_handle<> writer;
+    };
+
+    struct Timer
+    {
+        Clock::time_point deadline;
+        unsigned long long sequence;
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer &other) const
+        {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    std::vector<Task> _tasks;
+    std::deque<std::coroutine_handle<>> _ready;
+    std::unordered_map<int, Watch> _watching;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> _timers;
+    unsigned long long _timerSequence;
+
+#ifdef __linux__
+    int _epoll;
+
+    void updateInterest(const int fd, const bool existed)
+    {
+        const Watch &watch = _watching[fd];
+        epoll_event event = {};
+        event.data.fd = fd;
+        event.events = (watch.reader ? static_cast<uint32_t>(EPOLLIN) : 0u) | (watch.writer ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+
+        if (epoll_ctl(_epoll, existed ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+        }
+    }
+
+    void wait(const int timeoutMilliseconds)
+    {
+        epoll_event events[256];
+        const int count = epoll_wait(_epoll, events, 256, timeoutMilliseconds);
+
+        if (count < 0 && errno != EINTR)
+        {
+            throw std::system_error(errno, std::generic_category(), "epoll_wait");
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            const bool failed = events[i].events & (EPOLLERR | EPOLLHUP);
+            wake(events[i].data.fd, failed || (events[i].events & EPOLLIN), failed || (events[i].events & EPOLLOUT));
+        }
+    }
+
+    void forget(const int fd)
+    {
+        epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+    }
+#else
+    void updateInterest(const int, const bool) {}
+
+    void wait(const int timeoutMilliseconds)
+    {
+        std::vector<pollfd> descriptors;
+        descriptors.reserve(_watching.size());
+
+        for (const auto &watching : _watching)
+        {
+            pollfd descriptor = {};
+            descriptor.fd = watching.first;
+            descriptor.events = (watching.second.reader ? POLLIN : 0) | (watching.second.writer ? POLLOUT : 0);
+            descriptors.push_back(descriptor);
+        }
+
+        if (poll(descriptors.data(), descriptors.size(), timeoutMilliseconds) < 0 && errno != EINTR)
+        {
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
+
+        for (const pollfd &descriptor : descriptors)
+        {
+            const bool failed = descriptor.revents & (POLLERR | POLLHUP | POLLNVAL);
+            wake(descriptor.fd, failed || (descriptor.revents & POLLIN), failed || (descriptor.revents & POLLOUT));
+        }
+    }
+
+    void forget(const int) {}
+#endif
+
+    void watch(const int fd, const bool forWriting, const std::coroutine_handle<> handle)
+    {
+        const bool existed = _watching.count(fd);
+        Watch &watch = _watching[fd];
+        std::coroutine_handle<> &slot = forWriting ? watch.writer : watch.reader;
+
+        if (slot)
+        {
+            throw std::logic_error("Only one Task may await each direction of fd " + std::to_string(fd));
+        }
+
+        slot = handle;
+        updateInterest(fd, existed);
+    }
+
+    void wake(const int fd, const bool readable, const bool writable)
+    {
+        const auto found = _watching.find(fd);
+
+        if (found == _watching.end())
+        {
+            return;
+        }
+
+        Watch &watch = found->second;
+
+        if (readable && watch.reader)
+        {
+            _ready.push_back(std::exchange(watch.reader, nullptr));
+        }
+
+        if (writable && watch.writer)
+        {
+            _ready.push_back(std::exchange(watch.writer, nullptr));
+        }
+
+        if (!watch.reader && !watch.writer)
+        {
+            forget(fd);
+            _watching.erase(found);
+        }
+        else
+        {
+            updateInterest(fd, true);
+        }
+    }
+
+    int millisecondsUntilNextTimer(const Clock::time_point deadline) const
+    {
+        const Clock::time_point next = _timers.empty() ? deadline : std::min(deadline, _timers.top().deadline);
+
+        if (next == Clock::time_point::max())
+        {
+            return -1;
+        }
+
+        const Clock::duration remaining = next - Clock::now();
+
+        return remaining <= Clock::duration::zero()
+                   ? 0
+                   : static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+    }
+
+    void fireTimers()
+    {
+        const Clock::time_point now = Clock::now();
+
+        while (!_timers.empty() && _timers.top().deadline <= now)
+        {
+            _ready.push_back(_timers.top().handle);
+            _timers.pop();
+        }
+    }
+
+  public:
+    struct IoAwaiter
+    {
+        EventLoop &loop;
+        int fd;
+        bool forWriting;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle)
+        {
+            loop.watch(fd, forWriting, handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct SleepAwaiter
+    {
+        EventLoop &loop;
+        Clock::time_point deadline;
+
+        bool await_ready() const noexcept
+        {
+            return deadline <= Clock::now();
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle)
+        {
+            Timer timer = {deadline, loop._timerSequence++, handle};
+            loop._timers.push(timer);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    EventLoop() : _timerSequence(0)
+    {
+#ifdef __linux__
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+
+        if (_epoll < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "epoll_create1");
+        }
+#endif
+    }
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    ~EventLoop()
+    {
+#ifdef __linux__
+        close(_epoll);
+#endif
+    }
+
+    /**
+     * Schedules a Task to start on the next turn of the loop,
+     * which then owns it until the loop finishes running
+     */
+    void spawn(Task task)
+    {
+        _ready.push_back(task.handle());
+        _tasks.push_back(std::move(task));
+    }
+
+    IoAwaiter readable(const int fd)
+    {
+        return IoAwaiter{*this, fd, false};
+    }
+
+    IoAwaiter writable(const int fd)
+    {
+        return IoAwaiter{*this, fd, true};
+    }
+
+    SleepAwaiter sleepFor(const Clock::duration duration)
+    {
+        return SleepAwaiter{*this, Clock::now() + duration};
+    }
+
+    SleepAwaiter sleepUntil(const Clock::time_point deadline)
+    {
+        return SleepAwaiter{*this, deadline};
+    }
+
+    size_t inFlight() const
+    {
+        size_t count = 0;
+
+        for (const Task &task : _tasks)
+        {
+            count += !task.done();
+        }
+
+        return count;
+    }
+
+    /**
+     * Runs until every spawned Task has nothing left to wait on, or until the
+     * deadline passes, when any unfinished Tasks are abandoned and destroyed.
+     * Then rethrows the first failure, if any, and returns whether every
+     * Task finished.
+     */
+    bool run(const Clock::time_point deadline = Clock::time_point::max())
+    {
+        bool finishedInTime = true;
+
+        for (;;)
+        {
+            while (!_ready.empty())
+            {
+                const std::coroutine_handle<> handle = _ready.front();
+                _ready.pop_front();
+                handle.resume();
+            }
+
+            if (_watching.empty() && _timers.empty())
+            {
+                break;
+            }
+
+            if (Clock::now() >= deadline)
+            {
+                finishedInTime = false;
+                break;
+            }
+
+            wait(millisecondsUntilNextTimer(deadline));
+            fireTimers();
+        }
+
+        for (const auto &watching : _watching)
+        {
+            forget(watching.first);
+        }
+
+        _watching.clear();
+        _timers = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>();
+
+        std::vector<Task> finished;
+        finished.swap(_tasks);
+
+        for (const Task &task : finished)
+        {
+            task.rethrowIfFailed();
+        }
+
+        return finishedInTime;
+    }
+};
+} // namespace DidYouKnow
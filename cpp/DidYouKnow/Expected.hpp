@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cassert>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace DidYouKnow
+{
+template <typename E>
+struct Unexpected
+{
+    E error;
+};
+
+template <typename E>
+Unexpected<typename std::decay<E>::type> unexpected(E &&error)
+{
+    return Unexpected<typename std::decay<E>::type>{std::forward<E>(error)};
+}
+
+/**
+ * Holds either a value or the error that prevented one, so that failures
+ * can be returned, rather than thrown, and then chained through further
+ * operations that only run while there is still a value.
+ * When both types are trivially copyable, so is this, so it is passed
+ * around in registers just like a hand-written error code and result.
+ */
+template <typename T, typename E>
+class Expected
+{
+    static constexpr bool Trivial = std::is_trivially_copyable<T>::value && std::is_trivially_copyable<E>::value;
+
+    union
+    {
+        T _value;
+        E _error;
+    };
+
+    bool _hasValue;
+
+    void constructFrom(const Expected &other)
+    {
+        if (other._hasValue)
+        {
+            new (&_value) T(other._value);
+        }
+        else
+        {
+            new (&_error) E(other._error);
+        }
+
+        _hasValue = other._hasValue;
+    }
+
+    void constructFrom(Expected &&other)
+    {
+        if (other._hasValue)
+        {
+            new (&_value) T(std::move(other._value));
+        }
+        else
+        {
+            new (&_error) E(std::move(other._error));
+        }
+
+        _hasValue = other._hasValue;
+    }
+
+    void destroy()
+    {
+        if (_hasValue)
+        {
+            _value.~T();
+        }
+        else
+        {
+            _error.~E();
+        }
+    }
+
+  public:
+    typedef T value_type;
+    typedef E error_type;
+
+    Expected(const T &value) : _value(value), _hasValue(true) {}
+
+    Expected(T &&value) : _value(std::move(value)), _hasValue(true) {}
+
+    template <typename G>
+    Expected(const Unexpected<G> &unexpected) : _error(unexpected.error), _hasValue(false) {}
+
+    Expected(const Expected &other)
+        requires Trivial
+    = default;
+
+    Expected(const Expected &other)
+        requires(!Trivial)
+    {
+        constructFrom(other);
+    }
+
+    Expected(Expected &&other)
+        requires Trivial
+    = default;
+
+    Expected(Expected &&other)
+        requires(!Trivial)
+    {
+        constructFrom(std::move(other));
+    }
+
+    Expected &operator=(const Expected &other)
+        requires Trivial
+    = default;
+
+    Expected &operator=(const Expected &other)
+        requires(!Trivial)
+    {
+        if (this != &other)
+        {
+            destroy();
+            constructFrom(other);
+        }
+
+        return *this;
+    }
+
+    Expected &operator=(Expected &&other)
+        requires Trivial
+    = default;
+
+    Expected &operator=(Expected &&other)
+        requires(!Trivial)
+    {
+        if (this != &other)
+        {
+            destroy();
+            constructFrom(std::move(other));
+        }
+
+        return *this;
+    }
+
+    ~Expected()
+        requires Trivial
+    = default;
+
+    ~Expected()
+        requires(!Trivial)
+    {
+        destroy();
+    }
+
+    bool hasValue() const
+    {
+        return _hasValue;
+    }
+
+    explicit operator bool() const
+    {
+        return _hasValue;
+    }
+
+    const T &value() const
+    {
+        assert(_hasValue);
+        return _value;
+    }
+
+    const E &error() const
+    {
+        assert(!_hasValue);
+        return _error;
+    }
+
+    T valueOr(const T &fallback) const
+    {
+        return _hasValue ? _value : fallback;
+    }
+
+    /**
+     * Passes the value on to a function that may itself fail
+     */
+    template <typename F>
+    auto andThen(F function) const -> decltype(function(_value))
+    {
+        if (_hasValue)
+        {
+            return function(_value);
+        }
+
+        return unexpected(_error);
+    }
+
+    /**
+     * Passes the value on to a function that cannot fail
+     */
+    template <typename F>
+    auto transform(F function) const -> Expected<decltype(function(_value)), E>
+    {
+        if (_hasValue)
+        {
+            return function(_value);
+        }
+
+        return unexpected(_error);
+    }
+
+    /**
+     * Gives a function the chance to recover from the error
+     */
+    template <typename F>
+    Expected orElse(F function) const
+    {
+        if (_hasValue)
+        {
+            return *this;
+        }
+
+        return function(_error);
+    }
+
+    template <typename F>
+    auto transformError(F function) const -> Expected<T, decltype(function(_error))>
+    {
+        if (_hasValue)
+        {
+            return _value;
+        }
+
+        return unexpected(function(_error));
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Timing.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * How long each fixture took to build, and how many test invocations
+ * then declared it
+ */
+struct FixtureStatistics
+{
+    std::string name;
+    double buildNanoseconds;
+    const std::atomic<size_t> *uses;
+};
+
+class FixtureRegistry
+{
+    std::mutex _mutex;
+    std::vector<FixtureStatistics> _built;
+
+  public:
+    static FixtureRegistry &instance()
+    {
+        static FixtureRegistry registry;
+        return registry;
+    }
+
+    void record(const FixtureStatistics &statistics)
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _built.push_back(statistics);
+    }
+
+    std::vector<FixtureStatistics> built()
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        return _built;
+    }
+};
+
+inline std::string demangle(const char *mangled)
+{
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    const std::string name(status == 0 ? demangled : mangled);
+    std::free(demangled);
+    return name;
+}
+
+enum class FixtureScope
+{
+    Process,
+    Worker
+};
+
+/**
+ * Derive from this via the Curiously Recurring Template Pattern (CRTP)
+ * to make an expensive piece of test state lazily built on first use,
+ * then shared read-only by every test that declares it as a parameter.
+ * As the derived type is known at compile time, there is nothing virtual.
+ */
+template <typename Derived, FixtureScope Scope = FixtureScope::Process>
+class Fixture
+{
+    static std::atomic<size_t> &uses()
+    {
+        static std::atomic<size_t> count(0);
+        return count;
+    }
+
+    static const Derived *construct()
+    {
+        const Stopwatch::time_point started = Stopwatch::now();
+        const Derived *built = new Derived();
+        FixtureStatistics statistics = {demangle(typeid(Derived).name()), nanosecondsSince(started), &uses()};
+        FixtureRegistry::instance().record(statistics);
+        return built;
+    }
+
+  public:
+    static const Derived &shared()
+    {
+        if constexpr (Scope == FixtureScope::Process)
+        {
+            static const std::unique_ptr<const Derived> instance(construct());
+            return *instance;
+        }
+        else
+        {
+            thread_local const std::unique_ptr<const Derived> instance(construct());
+            return *instance;
+        }
+    }
+
+    /**
+     * What a test that declares the fixture as a parameter is handed, each
+     * time it is invoked, counted as one use, which per-test setup would
+     * have had to build.  Tests reaching for shared() themselves are not
+     * counted, as they did not ask for setup of their own.
+     */
+    static const Derived &declared()
+    {
+        uses().fetch_add(1, std::memory_order_relaxed);
+        return shared();
+    }
+};
+
+/**
+ * Summarises what sharing fixtures cost: the time they took to build, and
+ * how many times tests declared them, each of which per-test setup would
+ * have built again.  What that would have taken is not measured, so none
+ * is claimed.
+ */
+inline void reportFixtures(std::ostream &stream)
+{
+    const std::vector<FixtureStatistics> built = FixtureRegistry::instance().built();
+
+    if (built.empty())
+    {
+        return;
+    }
+
+    // A fixture built once per worker shares one count of uses across its builds
+    std::map<std::string, const std::atomic<size_t> *> usesByName;
+    double buildNanoseconds = 0;
+    size_t uses = 0;
+
+    for (const FixtureStatistics &statistics : built)
+    {
+        usesByName[statistics.name] = statistics.uses;
+        buildNanoseconds += statistics.buildNanoseconds;
+    }
+
+    for (const auto &named : usesByName)
+    {
+        uses += named.second->load();
+    }
+
+    const bool one = built.size() == 1;
+    stream << built.size() << (one ? " shared fixture took " : " shared fixtures took ") << formatDuration(buildNanoseconds)
+           << " to build, and tests declared " << (one ? "it " : "them ") << uses << (uses == 1 ? " time" : " times")
+           << std::endl;
+}
+} // namespace DidYouKnow
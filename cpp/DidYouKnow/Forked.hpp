@@ -0,0 +1,305 @@
+#pragma once
+
+#include "Parameterised.hpp"
+#include "Progress.hpp"
+#include "Result.hpp"
+#include "SmallFunction.hpp"
+#include "Timing.hpp"
+#include "Watchdog.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * Reads whatever has been written to a pipe, returning whether it has
+ * been closed
+ */
+inline bool readAvailable(const int fd, std::string &read)
+{
+    char buffer[4096];
+    const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+
+    if (count > 0)
+    {
+        read.append(buffer, static_cast<size_t>(count));
+    }
+    else if (count < 0 && errno != EINTR)
+    {
+        throw std::system_error(errno, std::generic_category(), "read");
+    }
+
+    return count == 0;
+}
+
+/**
+ * Waits for a child to exit, for at most the given grace period
+ */
+inline bool reap(const pid_t child, const std::chrono::milliseconds grace)
+{
+    const Watchdog::Clock::time_point deadline = Watchdog::Clock::now() + grace;
+
+    while (waitpid(child, nullptr, WNOHANG) == 0)
+    {
+        if (Watchdog::Clock::now() >= deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return true;
+}
+
+inline void writeAll(const int fd, const std::string &text)
+{
+    for (size_t written = 0; written < text.size();)
+    {
+        const ssize_t count = ::write(fd, text.data() + written, text.size() - written);
+
+        if (count < 0 && errno != EINTR)
+        {
+            return;
+        }
+
+        written += count > 0 ? static_cast<size_t>(count) : 0;
+    }
+}
+
+/**
+ * A test, or a group of tests that must run together, to run in a child
+ * process of its own, within the given number of per-test time budgets
+ */
+struct ForkedJob
+{
+    std::string activity;
+    std::vector<size_t> indexes;
+    int budgets;
+    SmallFunction<void(InstructionCounter &)> body;
+};
+
+/**
+ * A child running a ForkedJob, and what it has reported so far
+ */
+struct ForkedChild
+{
+    const ForkedJob *job;
+    pid_t pid;
+    int channel;
+    Watchdog::Clock::time_point deadline;
+    std::string report;
+};
+
+/**
+ * Forks a child that runs the job against its own copy of the results,
+ * then reports back over a pipe, one line per test: "passed <index>
+ * <nanoseconds> <instructions>" or "timedOut <index>", then "cases <count>"
+ */
+inline ForkedChild startChild(const ForkedJob &job, std::vector<TestResult> &results,
+                              const Watchdog::Clock::time_point deadline)
+{
+    std::cout.flush();
+    std::cerr.flush();
+    int channel[2];
+
+    if (pipe(channel) != 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "pipe");
+    }
+
+    const pid_t child = fork();
+
+    if (child < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "fork");
+    }
+
+    if (child > 0)
+    {
+        close(channel[1]);
+        return ForkedChild{&job, child, channel[0], deadline, std::string()};
+    }
+
+    close(channel[0]);
+    InstructionCounter counter;
+    std::vector<size_t> samples;
+
+    for (const size_t index : job.indexes)
+    {
+        samples.push_back(results[index].nanoseconds.size());
+    }
+
+    const size_t casesBefore = parameterisedCasesRun().load();
+
+    try
+    {
+        job.body(counter);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << job.activity << " threw " << e.what() << std::endl;
+        _exit(EXIT_FAILURE);
+    }
+
+    std::ostringstream report;
+
+    for (size_t i = 0; i < job.indexes.size(); ++i)
+    {
+        const TestResult &result = results[job.indexes[i]];
+
+        if (result.outcome == Outcome::TimedOut)
+        {
+            report << "timedOut " << job.indexes[i] << '\n';
+        }
+        else if (result.nanoseconds.size() > samples[i])
+        {
+            report << "passed " << job.indexes[i] << ' ' << result.nanoseconds.back() << ' '
+                   << result.instructions << '\n';
+        }
+    }
+
+    report << "cases " << parameterisedCasesRun().load() - casesBefore << '\n';
+    std::cout.flush();
+    writeAll(channel[1], report.str());
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * Reaps a child, killing it first if it ran out of time, then records what
+ * it reported.  Tests it said nothing about failed, or, if the child had to
+ * be killed, timed out.
+ */
+inline void finishChild(ForkedChild &child, std::vector<TestResult> &results, const bool timedOut)
+{
+    close(child.channel);
+
+    if (!timedOut)
+    {
+        waitpid(child.pid, nullptr, 0);
+    }
+    else
+    {
+        std::cerr << child.job->activity << " timed out" << std::endl;
+        kill(child.pid, SIGUSR1);
+
+        if (!reap(child.pid, std::chrono::seconds(1)))
+        {
+            kill(child.pid, SIGKILL);
+            waitpid(child.pid, nullptr, 0);
+        }
+    }
+
+    std::vector<Outcome> outcomes(results.size(), timedOut ? Outcome::TimedOut : Outcome::Failed);
+    std::istringstream lines(child.report);
+    std::string kind;
+
+    while (lines >> kind)
+    {
+        size_t index = 0;
+
+        if (kind == "cases" && lines >> index)
+        {
+            parameterisedCasesRun().fetch_add(index);
+        }
+        else if (kind == "timedOut" && lines >> index && index < results.size())
+        {
+            outcomes[index] = Outcome::TimedOut;
+        }
+        else if (kind == "passed" && lines >> index && index < results.size())
+        {
+            double nanoseconds = 0;
+            long long instructions = -1;
+            lines >> nanoseconds >> instructions;
+            results[index].nanoseconds.push_back(nanoseconds);
+            outcomes[index] = Outcome::Passed;
+
+            if (instructions >= 0 && (results[index].instructions < 0 || instructions < results[index].instructions))
+            {
+                results[index].instructions = instructions;
+            }
+        }
+    }
+
+    for (const size_t index : child.job->indexes)
+    {
+        results[index].outcome = outcomes[index];
+    }
+}
+
+/**
+ * Runs each job in a child process, so a test that crashes, fails an
+ * assertion or hangs takes only its child down with it, with up to the
+ * given number of children at once, started in the order of the jobs.
+ * Fixtures are built afresh in each child, so are not shared between jobs.
+ */
+inline void runForked(const std::vector<ForkedJob> &jobs, const size_t parallelism, std::vector<TestResult> &results,
+                      const Watchdog &watchdog, const Progress &progress)
+{
+    std::vector<ForkedChild> running;
+    size_t next = 0;
+
+    while (next < jobs.size() || !running.empty())
+    {
+        for (; running.size() < parallelism && next < jobs.size(); ++next)
+        {
+            for (const size_t index : jobs[next].indexes)
+            {
+                progress.started(results[index]);
+            }
+
+            running.push_back(startChild(jobs[next], results, watchdog.deadline(jobs[next].budgets)));
+        }
+
+        std::vector<pollfd> channels;
+        Watchdog::Clock::time_point earliest = Watchdog::Clock::time_point::max();
+
+        for (const ForkedChild &child : running)
+        {
+            channels.push_back(pollfd{child.channel, POLLIN, 0});
+            earliest = std::min(earliest, child.deadline);
+        }
+
+        const int timeout = earliest == Watchdog::Clock::time_point::max()
+                                ? -1
+                                : static_cast<int>(std::max<long long>(0, std::chrono::ceil<std::chrono::milliseconds>(earliest - Watchdog::Clock::now()).count()));
+
+        if (poll(channels.data(), channels.size(), timeout) < 0 && errno != EINTR)
+        {
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
+
+        for (size_t i = running.size(); i-- > 0;)
+        {
+            const bool closed = channels[i].revents && readAvailable(running[i].channel, running[i].report);
+            const bool timedOut = !closed && Watchdog::Clock::now() >= running[i].deadline;
+
+            if (closed || timedOut)
+            {
+                finishChild(running[i], results, timedOut);
+
+                for (const size_t index : running[i].job->indexes)
+                {
+                    progress.finished(results[index]);
+                }
+
+                running.erase(running.begin() + i);
+            }
+        }
+    }
+}
+} // namespace DidYouKnow
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Result.hpp"
+#include "Timing.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * A single line of the history file: the median time and instruction count
+ * of one test, from one run
+ */
+struct HistoryEntry
+{
+    unsigned long long run;
+    std::string test;
+    double nanoseconds;
+    long long instructions;
+};
+
+/**
+ * An append-only, whitespace-separated log of per-test timings,
+ * one line per test per run, which is cheap to write and trivial to read
+ */
+class History
+{
+    std::string _path;
+
+  public:
+    explicit History(const std::string &path) : _path(path) {}
+
+    const std::string &path() const
+    {
+        return _path;
+    }
+
+    std::vector<HistoryEntry> load() const
+    {
+        std::vector<HistoryEntry> entries;
+        std::ifstream file(_path.c_str());
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            HistoryEntry entry;
+
+            if (fields >> entry.run >> entry.test >> entry.nanoseconds >> entry.instructions)
+            {
+                entries.push_back(entry);
+            }
+        }
+
+        return entries;
+    }
+
+    bool append(const unsigned long long run, const std::vector<TestResult> &results) const
+    {
+        std::ofstream file(_path.c_str(), std::ios::app);
+
+        for (const TestResult &result : results)
+        {
+            file << run << ' ' << result.name << ' '
+                 << static_cast<long long>(median(result.nanoseconds)) << ' '
+                 << result.instructions << '\n';
+        }
+
+        return static_cast<bool>(file);
+    }
+
+    /**
+     * Gathers the recorded medians of each test from, at most,
+     * the most recent number of runs
+     */
+    std::map<std::string, std::vector<double>> baseline(const size_t runs) const
+    {
+        const std::vector<HistoryEntry> entries = load();
+        std::vector<unsigned long long> recentRuns;
+
+        for (auto entry = entries.rbegin(); entry != entries.rend() && recentRuns.size() <= runs; ++entry)
+        {
+            if (recentRuns.empty() || recentRuns.back() != entry->run)
+            {
+                recentRuns.push_back(entry->run);
+            }
+        }
+
+        const unsigned long long oldestRun =
+            recentRuns.empty() ? 0 : recentRuns[std::min(runs, recentRuns.size()) - 1];
+
+        std::map<std::string, std::vector<double>> timings;
+
+        for (const HistoryEntry &entry : entries)
+        {
+            if (entry.run >= oldestRun)
+            {
+                timings[entry.test].push_back(entry.nanoseconds);
+            }
+        }
+
+        return timings;
+    }
+};
+
+/**
+ * A test whose median time has moved beyond both the relative threshold
+ * and the noise previously observed for it
+ */
+struct Regression
+{
+    std::string test;
+    double baselineNanoseconds;
+    double currentNanoseconds;
+};
+
+struct RegressionThresholds
+{
+    double relative;
+    double sigmas;
+    double minimumNanoseconds;
+    size_t minimumRuns;
+};
+
+inline std::vector<Regression> findRegressions(const std::map<std::string, std::vector<double>> &baseline,
+                                               const std::vector<TestResult> &results,
+                                               const RegressionThresholds &thresholds)
+{
+    std::vector<Regression> regressions;
+
+    for (const TestResult &result : results)
+    {
+        const auto history = baseline.find(result.name);
+
+        if (history == baseline.end() || history->second.size() < thresholds.minimumRuns)
+        {
+            continue;
+        }
+
+        const double before = median(history->second);
+        const double after = median(result.nanoseconds);
+        const double slowdown = after - before;
+
+        if (slowdown > before * thresholds.relative &&
+            slowdown > thresholds.sigmas * robustSpread(history->second) &&
+            slowdown > thresholds.minimumNanoseconds)
+        {
+            Regression regression = {result.name, before, after};
+            regressions.push_back(regression);
+        }
+    }
+
+    return regressions;
+}
+} // namespace DidYouKnow
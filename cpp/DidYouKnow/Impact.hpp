@@ -0,0 +1,280 @@
+#pragma once
+
+#include "Test.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * The lines of each file changed since a revision, as first and last line
+ * numbers on the old side of the diff, which is the side the coverage
+ * index was recorded against.  A line added between two others counts as
+ * a change to both.
+ */
+typedef std::map<std::string, std::vector<std::pair<int, int>>> ChangedLines;
+
+inline bool changedSince(const std::string &revision, ChangedLines &changed)
+{
+    const std::string command = "git diff --unified=0 --relative " + revision + " 2>/dev/null";
+    FILE *output = popen(command.c_str(), "r");
+
+    if (!output)
+    {
+        return false;
+    }
+
+    std::string file;
+    char buffer[4096];
+
+    while (fgets(buffer, sizeof(buffer), output))
+    {
+        const std::string line(buffer);
+
+        if (line.rfind("--- ", 0) == 0)
+        {
+            file = line.compare(4, 9, "/dev/null") == 0 ? "" : line.substr(6, line.size() - 7);
+        }
+        else if (line.rfind("+++ ", 0) == 0 && file.empty())
+        {
+            // A new file, which no test can have covered yet
+            changed[line.substr(6, line.size() - 7)].push_back(std::make_pair(0, 0));
+        }
+        else if (line.rfind("@@ -", 0) == 0 && !file.empty())
+        {
+            int first = 0, count = 1;
+            std::sscanf(line.c_str(), "@@ -%d,%d", &first, &count);
+            changed[file].push_back(count ? std::make_pair(first, first + count - 1)
+                                          : std::make_pair(first, first + 1));
+        }
+    }
+
+    return pclose(output) == 0;
+}
+
+/**
+ * Which functions each test entered, as recorded by a coverage build
+ */
+class CoverageIndex
+{
+    // The first and last lines of each function entered, by file
+    std::map<std::string, std::set<std::pair<int, int>>> _functions;
+
+    // The file and starting line of each function entered, by test
+    std::map<std::string, std::set<std::pair<std::string, int>>> _tests;
+
+    // Every function entered by at least one test
+    std::set<std::pair<std::string, int>> _tested;
+
+    std::pair<std::string, int> _main;
+
+    const std::string *find(const std::string &changedFile) const
+    {
+        for (const auto &functions : _functions)
+        {
+            const std::string &file = functions.first;
+
+            if (file == changedFile ||
+                (file.size() > changedFile.size() && file.compare(file.size() - changedFile.size() - 1, std::string::npos, "/" + changedFile) == 0))
+            {
+                return &file;
+            }
+        }
+
+        return nullptr;
+    }
+
+  public:
+    explicit CoverageIndex(const std::string &path)
+    {
+        std::ifstream file(path.c_str());
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            std::string kind, test, path;
+            int start = 0, last = 0;
+
+            if (fields >> kind && kind == "test")
+            {
+                fields >> test;
+            }
+
+            fields >> start;
+
+            if (kind != "test")
+            {
+                fields >> last;
+            }
+
+            fields >> std::ws;
+            std::getline(fields, path);
+
+            if (path.empty())
+            {
+                continue;
+            }
+
+            if (kind == "function")
+            {
+                _functions[path].insert(std::make_pair(start, last));
+            }
+            else if (kind == "test")
+            {
+                _tests[test].insert(std::make_pair(path, start));
+                _tested.insert(std::make_pair(path, start));
+            }
+            else if (kind == "main")
+            {
+                _main = std::make_pair(path, start);
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        return _tests.empty();
+    }
+
+    bool covers(const char *test) const
+    {
+        return _tests.count(test) != 0;
+    }
+
+    /**
+     * The starts of the functions spanning the changed lines, or false if
+     * any changed line falls outside every function a test entered, such as
+     * in a type, a global, or the runner, where the index cannot tell what
+     * it affects.  The body of main only registers tests, so changes to it
+     * are left to the check for tests missing from the index.
+     */
+    bool touched(const ChangedLines &changed, std::set<std::pair<std::string, int>> &functions) const
+    {
+        for (const auto &lines : changed)
+        {
+            const std::string *file = find(lines.first);
+
+            if (!file)
+            {
+                return false;
+            }
+
+            for (const std::pair<int, int> &range : lines.second)
+            {
+                // The first changed line not yet known to be within a function
+                int uncovered = range.first;
+
+                for (const std::pair<int, int> &extent : _functions.at(*file))
+                {
+                    if (extent.first > range.second)
+                    {
+                        break;
+                    }
+
+                    if (extent.second < range.first)
+                    {
+                        continue;
+                    }
+
+                    if (extent.first > uncovered)
+                    {
+                        return false;
+                    }
+
+                    const std::pair<std::string, int> start(*file, extent.first);
+
+                    if (start != _main && !_tested.count(start))
+                    {
+                        return false;
+                    }
+
+                    functions.insert(start);
+                    uncovered = std::max(uncovered, extent.second + 1);
+                }
+
+                if (uncovered <= range.second)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool entered(const char *test, const std::set<std::pair<std::string, int>> &functions) const
+    {
+        const auto covered = _tests.find(test);
+
+        if (covered == _tests.end())
+        {
+            return false;
+        }
+
+        for (const std::pair<std::string, int> &function : functions)
+        {
+            if (covered->second.count(function))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
+
+/**
+ * The tests that could be affected by changes since a revision: those that
+ * entered a changed function, and those the index has never seen.  Whenever
+ * that cannot be worked out, every test is affected.
+ */
+inline std::vector<Test> affectedTests(const std::vector<Test> &tests, const std::string &revision,
+                                       const std::string &indexPath, std::ostream &log)
+{
+    const CoverageIndex index(indexPath);
+    ChangedLines changed;
+    std::set<std::pair<std::string, int>> functions;
+
+    if (index.empty())
+    {
+        log << "No coverage index at " << indexPath << ", so running every test" << std::endl;
+        return tests;
+    }
+
+    if (!changedSince(revision, changed))
+    {
+        log << "Could not diff against " << revision << ", so running every test" << std::endl;
+        return tests;
+    }
+
+    if (!index.touched(changed, functions))
+    {
+        log << "Changes since " << revision << " fall outside the coverage index, so running every test" << std::endl;
+        return tests;
+    }
+
+    std::vector<Test> affected;
+
+    for (const Test &test : tests)
+    {
+        if (!index.covers(test.name) || index.entered(test.name, functions))
+        {
+            affected.push_back(test);
+        }
+    }
+
+    log << "Running " << affected.size() << " of " << tests.size() << " tests affected by changes since "
+        << revision << std::endl;
+    return affected;
+}
+} // namespace DidYouKnow
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * The on-disk layout of a MappedTable: a header, then an entry per key,
+ * sorted by key, then every key and value, back to back.  Offsets are from
+ * the start of those strings, so the image holds no pointers, and can be
+ * used wherever it is mapped.  Integers are in the byte order of the
+ * machine that wrote them, which the magic number checks.
+ */
+struct MappedTableHeader
+{
+    static const uint64_t Magic = 0x31306261544B5944; // "DYKTab01" on little-endian machines
+
+    uint64_t magic;
+    uint64_t count;
+};
+
+struct MappedTableEntry
+{
+    uint64_t keyOffset;
+    uint64_t valueOffset;
+    uint32_t keyLength;
+    uint32_t valueLength;
+};
+
+/**
+ * Writes a map as a MappedTable image, to a temporary file that then
+ * replaces the one at the path, so processes still mapping the old image
+ * keep reading it, unchanged, until they map it again
+ */
+inline void writeMappedTable(const std::string &path, const std::map<std::string, std::string> &map)
+{
+    std::vector<MappedTableEntry> entries;
+    std::string strings;
+    entries.reserve(map.size());
+
+    for (const auto &entry : map)
+    {
+        if (entry.first.size() > UINT32_MAX || entry.second.size() > UINT32_MAX)
+        {
+            throw std::invalid_argument("Too long to write to a mapped table: " + entry.first.substr(0, 64));
+        }
+
+        entries.push_back(MappedTableEntry{strings.size(), strings.size() + entry.first.size(),
+                                           static_cast<uint32_t>(entry.first.size()),
+                                           static_cast<uint32_t>(entry.second.size())});
+        strings += entry.first;
+        strings += entry.second;
+    }
+
+    const MappedTableHeader header{MappedTableHeader::Magic, entries.size()};
+    const std::string temporary = path + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+
+    if (!file)
+    {
+        throw std::system_error(errno, std::generic_category(), "Could not write " + temporary);
+    }
+
+    const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         std::fwrite(entries.data(), sizeof(MappedTableEntry), entries.size(), file) == entries.size() &&
+                         std::fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+
+    if (std::fclose(file) != 0 || !written || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        const int error = errno;
+        std::remove(temporary.c_str());
+        throw std::system_error(error, std::generic_category(), "Could not write " + path);
+    }
+}
+
+/**
+ * A read-only map of strings served straight from a memory-mapped image,
+ * so opening one costs the same however many entries it holds, and its
+ * pages are loaded on demand, and shared through the page cache with every
+ * other process mapping the same file.  Lookups are binary searches over
+ * the sorted entries, returning views into the mapping, which stay valid
+ * for as long as the table does.
+ */
+class MappedTable
+{
+    void *_mapping;
+    size_t _size;
+    const MappedTableEntry *_entries;
+    uint64_t _count;
+    const char *_strings;
+    size_t _stringsSize;
+
+    std::string_view view(const uint64_t offset, const uint32_t length) const
+    {
+        // Checked as each string is read, rather than all of them on
+        // opening, which would cost as much as parsing them
+        if (offset > _stringsSize || length > _stringsSize - offset)
+        {
+            throw std::invalid_argument("Mapped table entry out of bounds");
+        }
+
+        return std::string_view(_strings + offset, length);
+    }
+
+  public:
+    explicit MappedTable(const std::string &path) : _mapping(MAP_FAILED), _size(0)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "Could not open " + path);
+        }
+
+        struct stat status;
+
+        if (fstat(fd, &status) != 0)
+        {
+            const int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "Could not stat " + path);
+        }
+
+        _size = static_cast<size_t>(status.st_size);
+        _mapping = _size < sizeof(MappedTableHeader) ? MAP_FAILED : mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        const int error = errno;
+        close(fd);
+
+        if (_size < sizeof(MappedTableHeader))
+        {
+            throw std::invalid_argument(path + " is too short to be a mapped table");
+        }
+
+        if (_mapping == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(), "Could not map " + path);
+        }
+
+        const MappedTableHeader *header = static_cast<const MappedTableHeader *>(_mapping);
+        _count = header->count;
+
+        if (header->magic != MappedTableHeader::Magic ||
+            _count > (_size - sizeof(MappedTableHeader)) / sizeof(MappedTableEntry))
+        {
+            munmap(_mapping, _size);
+            throw std::invalid_argument(path + " is not a mapped table written on this machine");
+        }
+
+        _entries = reinterpret_cast<const MappedTableEntry *>(header + 1);
+        _strings = reinterpret_cast<const char *>(_entries + _count);
+        _stringsSize = _size - (_strings - static_cast<const char *>(_mapping));
+    }
+
+    MappedTable(const MappedTable &) = delete;
+    MappedTable &operator=(const MappedTable &) = delete;
+
+    ~MappedTable()
+    {
+        munmap(_mapping, _size);
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(_count);
+    }
+
+    std::string_view key(const size_t index) const
+    {
+        return view(_entries[index].keyOffset, _entries[index].keyLength);
+    }
+
+    std::string_view value(const size_t index) const
+    {
+        return view(_entries[index].valueOffset, _entries[index].valueLength);
+    }
+
+    std::optional<std::string_view> find(const std::string_view key) const
+    {
+        size_t first = 0, last = size();
+
+        while (first < last)
+        {
+            const size_t middle = first + (last - first) / 2;
+            const int comparison = this->key(middle).compare(key);
+
+            if (comparison == 0)
+            {
+                return value(middle);
+            }
+
+            if (comparison < 0)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                last = middle;
+            }
+        }
+
+        return std::nullopt;
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <locale.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * Whether eight bytes, loaded little-endian, are all ASCII digits, checked
+ * together within one register rather than a byte at a time: each high
+ * nibble must be 3, and must stay 3 once 6 is added to each byte
+ */
+inline bool allEightDigits(const uint64_t bytes)
+{
+    return ((bytes & 0xF0F0F0F0F0F0F0F0) | (((bytes + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+           0x3333333333333333;
+}
+
+/**
+ * The value of eight ASCII digits, loaded little-endian, combining pairs of
+ * digits, then pairs of pairs, in three multiplications rather than eight
+ */
+inline uint32_t parseEightDigits(uint64_t bytes)
+{
+    bytes -= 0x3030303030303030;
+    bytes = bytes * 10 + (bytes >> 8);
+    bytes = ((bytes & 0x000000FF000000FF) * (100 + (1000000ULL << 32)) +
+             ((bytes >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >>
+            32;
+    return static_cast<uint32_t>(bytes);
+}
+
+/**
+ * Parses an integer from the start of [first, last), as std::from_chars
+ * does, and so without regard to locale, taking eight digits at a time
+ * where it can.  Returns where the integer ended, or nullptr if there was
+ * none, or it was out of range.
+ */
+template <typename Integer>
+inline const char *parseInteger(const char *first, const char *last, Integer &value)
+{
+    static_assert(std::is_integral<Integer>::value, "parseInteger parses integers");
+
+    const bool negative = first != last && *first == '-';
+    const char *const digits = first + negative;
+    const char *end = digits;
+    uint64_t magnitude = 0;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (last - end >= 8 && end - digits <= 8)
+    {
+        uint64_t bytes;
+        std::memcpy(&bytes, end, sizeof(bytes));
+
+        if (!allEightDigits(bytes))
+        {
+            break;
+        }
+
+        magnitude = magnitude * 100000000 + parseEightDigits(bytes);
+        end += 8;
+    }
+#endif
+
+    while (end != last && static_cast<unsigned char>(*end - '0') < 10 && end - digits < 19)
+    {
+        magnitude = magnitude * 10 + static_cast<unsigned char>(*end - '0');
+        ++end;
+    }
+
+    const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<Integer>::max()) + (negative ? 1 : 0);
+
+    if (end == digits || (negative && std::is_unsigned<Integer>::value) || magnitude > limit ||
+        (end != last && static_cast<unsigned char>(*end - '0') < 10))
+    {
+        // No digits, too many, or a sign where none is allowed, all of which
+        // are rare enough to leave to the standard library to judge
+        const std::from_chars_result result = std::from_chars(first, last, value);
+        return result.ec == std::errc() ? result.ptr : nullptr;
+    }
+
+    value = static_cast<Integer>(negative ? 0 - magnitude : magnitude);
+    return end;
+}
+
+/**
+ * Parses a real number from the start of [first, last), in the C locale
+ * whatever the global one, returning where it ended, or nullptr if there
+ * was none
+ */
+inline const char *parseReal(const char *first, const char *last, double &value)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const std::from_chars_result result = std::from_chars(first, last, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+    // Standard libraries without floating-point from_chars fall back to
+    // strtod, which needs a terminated copy, and follows the global locale
+    // unless given the C one to use instead
+    static const locale_t c = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+    char copy[128];
+    const size_t length = std::min<size_t>(last - first, sizeof(copy) - 1);
+    std::memcpy(copy, first, length);
+    copy[length] = '\0';
+    char *end = nullptr;
+    value = strtod_l(copy, &end, c);
+    return end == copy ? nullptr : first + (end - copy);
+#endif
+}
+
+/**
+ * Appends a number as its shortest round-tripping text, without regard to
+ * locale, and without an intermediate string
+ */
+template <typename Number>
+inline void appendNumber(std::string &out, const Number number)
+{
+    char digits[32];
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), number).ptr);
+}
+
+/**
+ * Parses every integer in a buffer, separated by whitespace, appending
+ * them to values, as reading from an istream_iterator would, but throwing
+ * std::invalid_argument at anything else
+ */
+template <typename Integer>
+inline void parseIntegers(const std::string_view text, std::vector<Integer> &values)
+{
+    const char *position = text.data();
+    const char *const last = position + text.size();
+
+    for (;;)
+    {
+        while (position != last && (*position == ' ' || (*position >= '\t' && *position <= '\r')))
+        {
+            ++position;
+        }
+
+        if (position == last)
+        {
+            return;
+        }
+
+        Integer value;
+        const char *const end = parseInteger(position, last, value);
+
+        if (!end)
+        {
+            throw std::invalid_argument("Not an integer at offset " + std::to_string(position - text.data()));
+        }
+
+        values.push_back(value);
+        position = end;
+    }
+}
+
+enum class ColumnType
+{
+    Integer,
+    Real
+};
+
+/**
+ * Rows of delimited numbers, held a column at a time, each of its own type,
+ * as read from or written to text such as CSV, in a single pass over one
+ * buffer, rather than through a stream per line or per value
+ */
+class Columns
+{
+    std::vector<ColumnType> _types;
+    std::vector<std::vector<long long>> _integers;
+    std::vector<std::vector<double>> _reals;
+
+    // Where each column is held, within _integers or _reals
+    std::vector<size_t> _slots;
+
+    size_t _rows;
+
+    void truncate()
+    {
+        for (std::vector<long long> &integers : _integers)
+        {
+            integers.resize(_rows);
+        }
+
+        for (std::vector<double> &reals : _reals)
+        {
+            reals.resize(_rows);
+        }
+    }
+
+  public:
+    explicit Columns(const std::vector<ColumnType> &types) : _types(types), _rows(0)
+    {
+        for (const ColumnType type : types)
+        {
+            _slots.push_back(type == ColumnType::Integer ? _integers.size() : _reals.size());
+
+            if (type == ColumnType::Integer)
+            {
+                _integers.emplace_back();
+            }
+            else
+            {
+                _reals.emplace_back();
+            }
+        }
+    }
+
+    size_t rows() const
+    {
+        return _rows;
+    }
+
+    const std::vector<long long> &integers(const size_t column) const
+    {
+        if (column >= _types.size() || _types[column] != ColumnType::Integer)
+        {
+            throw std::invalid_argument("Column " + std::to_string(column) + " does not hold integers");
+        }
+
+        return _integers[_slots[column]];
+    }
+
+    const std::vector<double> &reals(const size_t column) const
+    {
+        if (column >= _types.size() || _types[column] != ColumnType::Real)
+        {
+            throw std::invalid_argument("Column " + std::to_string(column) + " does not hold real numbers");
+        }
+
+        return _reals[_slots[column]];
+    }
+
+    /**
+     * Appends every row of the text, skipping blank lines, and accepting
+     * either line ending.  A malformed row throws std::invalid_argument,
+     * naming it, and leaves the rows before it in place.
+     */
+    void parse(const std::string_view text, const char delimiter = ',')
+    {
+        const char *position = text.data();
+        const char *const last = position + text.size();
+
+        for (size_t line = 1; position != last; ++line)
+        {
+            if (*position == '\n' || *position == '\r')
+            {
+                position += *position == '\r' && position + 1 != last && position[1] == '\n' ? 2 : 1;
+                continue;
+            }
+
+            for (size_t column = 0; column < _types.size(); ++column)
+            {
+                const char *const end = _types[column] == ColumnType::Integer
+                                            ? parseInteger(position, last, _integers[_slots[column]].emplace_back())
+                                            : parseReal(position, last, _reals[_slots[column]].emplace_back());
+                const char expected = column + 1 < _types.size() ? delimiter : '\n';
+
+                if (!end || (end != last && *end != expected && !(expected == '\n' && *end == '\r')))
+                {
+                    truncate();
+                    throw std::invalid_argument("Malformed column " + std::to_string(column + 1) + " on line " +
+                                                std::to_string(line));
+                }
+
+                position = end == last ? end : end + 1;
+
+                if (end == last && column + 1 < _types.size())
+                {
+                    truncate();
+                    throw std::invalid_argument("Too few columns on line " + std::to_string(line));
+                }
+            }
+
+            if (position != last && position[-1] == '\r' && *position == '\n')
+            {
+                ++position;
+            }
+
+            ++_rows;
+        }
+    }
+
+    /**
+     * Appends every row to one growing buffer, each number as its shortest
+     * round-tripping text
+     */
+    void format(std::string &out, const char delimiter = ',') const
+    {
+        for (size_t row = 0; row < _rows; ++row)
+        {
+            for (size_t column = 0; column < _types.size(); ++column)
+            {
+                if (_types[column] == ColumnType::Integer)
+                {
+                    appendNumber(out, _integers[_slots[column]][row]);
+                }
+                else
+                {
+                    appendNumber(out, _reals[_slots[column]][row]);
+                }
+
+                out += column + 1 < _types.size() ? delimiter : '\n';
+            }
+        }
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,257 @@
+#pragma once
+
+#include "History.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace DidYouKnow
+{
+/**
+ * Command-line options understood by the runner
+ */
+struct Options
+{
+    std::string historyPath;
+    bool recordHistory;
+    bool compareBaseline;
+    size_t samples;
+    size_t baselineRuns;
+    RegressionThresholds thresholds;
+    bool profile;
+    std::string profileDirectory;
+    int profileHertz;
+    bool list;
+    std::chrono::milliseconds timeout;
+    std::chrono::milliseconds globalTimeout;
+    bool fork;
+    std::string coverageIndex;
+    std::string changedSince;
+    size_t jobs;
+    size_t threads;
+    unsigned long long seed;
+    bool registeredOrder;
+    std::string schedulePath;
+    std::string replayOrder;
+    std::string jsonLinesPath;
+    std::string junitPath;
+
+    Options()
+        : historyPath("build/history.log"), recordHistory(true), compareBaseline(false),
+          samples(1), baselineRuns(20), profile(false), profileDirectory("build/profile"), profileHertz(997),
+          list(false), timeout(30000), globalTimeout(0), fork(false),
+          coverageIndex("build/coverage.index"), jobs(1), threads(1), seed(0), registeredOrder(false),
+          schedulePath("build/schedule.log")
+    {
+        thresholds.relative = 0.25;
+        thresholds.sigmas = 3;
+        thresholds.minimumNanoseconds = 1000;
+        thresholds.minimumRuns = 3;
+    }
+
+    static const char *usage()
+    {
+        return "Usage: main.exe [options]\n"
+               "  --history <path>         Timing history file (default build/history.log)\n"
+               "  --no-history             Do not record this run\n"
+               "  --samples <n>            Times to run each test (default 1, or 5 when comparing)\n"
+               "  --compare-baseline       Fail if any test is slower than its recorded baseline\n"
+               "  --baseline-runs <n>      Recent runs that form the baseline (default 20)\n"
+               "  --threshold <percent>    Relative slowdown treated as a regression (default 25)\n"
+               "  --sigmas <n>             Slowdown, in baseline deviations, beyond noise (default 3)\n"
+               "  --min-delta <ns>         Ignore slowdowns smaller than this (default 1000)\n"
+               "  --profile                Sample stacks with SIGPROF, writing folded stacks per test\n"
+               "  --profile-dir <path>     Where to write them (default build/profile)\n"
+               "  --profile-hz <n>         Samples per second of CPU time (default 997)\n"
+               "  --list                   List each test, and whether it ran at compile time or runtime\n"
+               "  --timeout <ms>           Time allowed for each test, or 0 for none (default 30000),\n"
+               "                           ending the run when overrun, unless with --fork\n"
+               "  --global-timeout <ms>    Time allowed for the whole run, or 0 for none (default 0)\n"
+               "  --fork                   Run each test in a child process, isolating crashes and hangs\n"
+               "  --coverage-index <path>  Functions each test entered, from a coverage build (default build/coverage.index)\n"
+               "  --changed-since <rev>    Run only the tests that entered code changed since a git revision\n"
+               "  --jobs <n>               Run up to this many tests at once, each forked (default 1)\n"
+               "  --threads <n>            Run tests marked thread-safe on this many threads, in process (default 1)\n"
+               "  --seed <n>               Breaks ties when ordering tests, for a reproducible order (default 0)\n"
+               "  --registered-order       Run tests in the order registered, not failing and flaky first\n"
+               "  --schedule <path>        Outcomes and durations used to order tests (default build/schedule.log)\n"
+               "  --replay-order <path>    Run tests in the order an earlier run saved, such as <schedule>.order from CI\n"
+               "  --jsonl <path>           Write each test's result as a line of JSON\n"
+               "  --junit <path>           Write the results as JUnit XML\n";
+    }
+
+    static Options parse(const int argc, char *argv[])
+    {
+        Options options;
+        bool samplesGiven = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument(argv[i]);
+
+            const auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::invalid_argument(argument + " requires a value");
+                }
+
+                return argv[++i];
+            };
+
+            const auto number = [&]() -> double
+            {
+                const std::string text = value();
+                char *end = nullptr;
+                const double parsed = std::strtod(text.c_str(), &end);
+
+                if (text.empty() || *end || parsed < 0)
+                {
+                    throw std::invalid_argument(argument + " expects a non-negative number, not " + text);
+                }
+
+                return parsed;
+            };
+
+            if (argument == "--history")
+            {
+                options.historyPath = value();
+            }
+            else if (argument == "--no-history")
+            {
+                options.recordHistory = false;
+            }
+            else if (argument == "--samples")
+            {
+                options.samples = static_cast<size_t>(number());
+                samplesGiven = true;
+            }
+            else if (argument == "--compare-baseline")
+            {
+                options.compareBaseline = true;
+            }
+            else if (argument == "--baseline-runs")
+            {
+                options.baselineRuns = static_cast<size_t>(number());
+            }
+            else if (argument == "--threshold")
+            {
+                options.thresholds.relative = number() / 100;
+            }
+            else if (argument == "--sigmas")
+            {
+                options.thresholds.sigmas = number();
+            }
+            else if (argument == "--min-delta")
+            {
+                options.thresholds.minimumNanoseconds = number();
+            }
+            else if (argument == "--profile")
+            {
+                options.profile = true;
+            }
+            else if (argument == "--profile-dir")
+            {
+                options.profileDirectory = value();
+            }
+            else if (argument == "--profile-hz")
+            {
+                options.profileHertz = static_cast<int>(number());
+            }
+            else if (argument == "--list")
+            {
+                options.list = true;
+            }
+            else if (argument == "--timeout")
+            {
+                options.timeout = std::chrono::milliseconds(static_cast<long long>(number()));
+            }
+            else if (argument == "--global-timeout")
+            {
+                options.globalTimeout = std::chrono::milliseconds(static_cast<long long>(number()));
+            }
+            else if (argument == "--fork")
+            {
+                options.fork = true;
+            }
+            else if (argument == "--coverage-index")
+            {
+                options.coverageIndex = value();
+            }
+            else if (argument == "--changed-since")
+            {
+                options.changedSince = value();
+            }
+            else if (argument == "--jobs")
+            {
+                options.jobs = static_cast<size_t>(number());
+                options.fork = options.fork || options.jobs > 1;
+            }
+            else if (argument == "--threads")
+            {
+                options.threads = static_cast<size_t>(number());
+            }
+            else if (argument == "--seed")
+            {
+                options.seed = static_cast<unsigned long long>(number());
+            }
+            else if (argument == "--registered-order")
+            {
+                options.registeredOrder = true;
+            }
+            else if (argument == "--schedule")
+            {
+                options.schedulePath = value();
+            }
+            else if (argument == "--replay-order")
+            {
+                options.replayOrder = value();
+            }
+            else if (argument == "--jsonl")
+            {
+                options.jsonLinesPath = value();
+            }
+            else if (argument == "--junit")
+            {
+                options.junitPath = value();
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + argument);
+            }
+        }
+
+        if (options.compareBaseline && !samplesGiven)
+        {
+            options.samples = 5;
+        }
+
+        if (options.samples < 1 || options.baselineRuns < 1 || options.profileHertz < 1 || options.jobs < 1 ||
+            options.threads < 1)
+        {
+            throw std::invalid_argument("--samples, --baseline-runs, --profile-hz, --jobs and --threads must be at least 1");
+        }
+
+        if (options.fork && options.threads > 1)
+        {
+            throw std::invalid_argument("--threads runs tests in process, so cannot be combined with --fork or --jobs");
+        }
+
+        if ((options.fork || options.threads > 1) && options.profile)
+        {
+            throw std::invalid_argument("--profile cannot sample tests run with --fork or --threads");
+        }
+
+#ifdef DIDYOUKNOW_COVERAGE
+        if (options.fork || options.threads > 1)
+        {
+            throw std::invalid_argument("Coverage cannot be recorded from tests run with --fork or --threads");
+        }
+#endif
+
+        return options;
+    }
+};
+} // namespace DidYouKnow
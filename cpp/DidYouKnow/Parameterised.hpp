@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SmallFunction.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace DidYouKnow
+{
+inline std::atomic<size_t> &parameterisedCasesRun()
+{
+    static std::atomic<size_t> count(0);
+    return count;
+}
+
+/**
+ * Runs a test body against every row of a table, such as a std::array
+ * of inputs and expected outputs, so that each case is one line of data
+ * rather than yet another hand-written test function
+ */
+template <typename Table>
+void forEachCase(const Table &table, const SmallFunction<void(const typename Table::value_type &)> &body)
+{
+    size_t count = 0;
+
+    for (const typename Table::value_type &row : table)
+    {
+        body(row);
+        ++count;
+    }
+
+    parameterisedCasesRun().fetch_add(count, std::memory_order_relaxed);
+}
+
+/**
+ * Runs a test body against each case made by a generator,
+ * which is handed the index of the case to make
+ */
+template <typename Case>
+void forEachGenerated(const size_t count, const SmallFunction<Case(size_t)> &generate, const SmallFunction<void(const Case &)> &body)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        body(generate(i));
+    }
+
+    parameterisedCasesRun().fetch_add(count, std::memory_order_relaxed);
+}
+} // namespace DidYouKnow
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Fixture.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * A sampling profiler driven by SIGPROF, which fires after every interval
+ * of CPU time used by the process.  Each sample captures the stack via the
+ * unwind tables and is tagged with whichever test was running at the time,
+ * so that each test gets its own folded stacks, ready for a flame graph.
+ */
+class Profiler
+{
+  public:
+    static const int Runner = -1;
+    static const int EventLoop = -2;
+
+  private:
+    static const int MaximumDepth = 64;
+
+    // The signal handler and the trampoline that called it
+    static const int SkippedFrames = 2;
+
+    struct Sample
+    {
+        int test;
+        int depth;
+        void *frames[MaximumDepth];
+    };
+
+    static inline std::atomic<int> _current{Runner};
+    static inline std::atomic<size_t> _taken{0};
+    static inline std::vector<Sample> _samples;
+
+    static void onSignal(int)
+    {
+        const int savedErrno = errno;
+        const size_t slot = _taken.fetch_add(1, std::memory_order_relaxed);
+
+        if (slot < _samples.size())
+        {
+            Sample &sample = _samples[slot];
+            sample.test = _current.load(std::memory_order_relaxed);
+            sample.depth = backtrace(sample.frames, MaximumDepth);
+        }
+
+        errno = savedErrno;
+    }
+
+    static std::string symbolise(void *address, std::map<void *, std::string> &cache)
+    {
+        const auto cached = cache.find(address);
+
+        if (cached != cache.end())
+        {
+            return cached->second;
+        }
+
+        Dl_info info;
+        std::string name;
+
+        if (dladdr(address, &info) && info.dli_sname)
+        {
+            name = demangle(info.dli_sname);
+        }
+        else
+        {
+            std::ostringstream hexadecimal;
+            hexadecimal << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(address);
+            name = hexadecimal.str();
+        }
+
+        for (char &character : name)
+        {
+            if (character == ';')
+            {
+                character = ',';
+            }
+        }
+
+        return cache[address] = name;
+    }
+
+  public:
+    static void tag(const int test)
+    {
+        _current.store(test, std::memory_order_relaxed);
+    }
+
+    static int tagged()
+    {
+        return _current.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Preallocates room for the samples, so the signal handler never
+     * allocates, then starts the timer
+     */
+    static void start(const int hertz, const size_t capacity)
+    {
+        void *warmUp[1];
+        backtrace(warmUp, 1);
+
+        _samples.assign(capacity, Sample());
+        _taken.store(0);
+
+        struct sigaction action = {};
+        action.sa_handler = &onSignal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+
+        itimerval timer = {};
+        timer.it_interval.tv_usec = 1000000 / hertz;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_PROF, &timer, nullptr);
+    }
+
+    static void stop()
+    {
+        const itimerval disarmed = {};
+        setitimer(ITIMER_PROF, &disarmed, nullptr);
+        signal(SIGPROF, SIG_IGN);
+    }
+
+    static size_t samplesTaken()
+    {
+        return std::min(_taken.load(), _samples.size());
+    }
+
+    /**
+     * Writes one file of folded stacks per test that was sampled,
+     * returning how many files were written
+     */
+    static size_t write(const std::string &directory, const std::vector<std::string> &testNames)
+    {
+        mkdir(directory.c_str(), 0755);
+
+        std::map<void *, std::string> symbols;
+        std::map<int, std::map<std::string, size_t>> stacksByTest;
+
+        for (size_t i = 0; i < samplesTaken(); ++i)
+        {
+            const Sample &sample = _samples[i];
+            std::string stack;
+
+            for (int frame = sample.depth - 1; frame >= SkippedFrames; --frame)
+            {
+                stack += (stack.empty() ? "" : ";") + symbolise(sample.frames[frame], symbols);
+            }
+
+            ++stacksByTest[sample.test][stack];
+        }
+
+        for (const auto &stacks : stacksByTest)
+        {
+            const std::string name = stacks.first == EventLoop ? "EventLoop"
+                                     : stacks.first < 0      ? "Runner"
+                                                             : testNames[stacks.first];
+
+            std::ofstream file((directory + "/" + name + ".folded").c_str());
+
+            for (const auto &stack : stacks.second)
+            {
+                file << stack.first << ' ' << stack.second << '\n';
+            }
+        }
+
+        return stacksByTest.size();
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Numbers.hpp"
+#include "Reporter.hpp"
+#include "Result.hpp"
+#include "Timing.hpp"
+
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+namespace DidYouKnow
+{
+/**
+ * Passes on each test's progress as it happens, from the thread that ran
+ * it, or the parent of the child that did, so that a run that ends early,
+ * such as when an assertion fails in process, still leaves a record of how
+ * far it got.  Each test started and finished is appended to a journal
+ * as a line of its own, "started <test>" or "finished <test> <outcome>
+ * <nanoseconds>", with a single write, so lines from different threads
+ * never interleave, and each finished test is passed to the reporter, when
+ * there is one.  A test is finished once it has taken every sample asked
+ * for, or failed.  Lines are formatted into a buffer kept by each thread,
+ * so nothing is allocated per test once it has grown, and with neither a
+ * journal nor a reporter, nothing is done at all.
+ */
+class Progress
+{
+    int _journal;
+    size_t _samples;
+    Reporter *_reporter;
+
+    static std::string &line()
+    {
+        thread_local std::string line;
+        line.clear();
+        return line;
+    }
+
+    void append(const std::string &line) const
+    {
+        if (_journal >= 0)
+        {
+            const ssize_t written = ::write(_journal, line.data(), line.size());
+            static_cast<void>(written);
+        }
+    }
+
+  public:
+    /**
+     * An empty journal path keeps no journal
+     */
+    Progress(const std::string &journalPath, const size_t samples, Reporter *reporter = nullptr)
+        : _journal(journalPath.empty() ? -1 : open(journalPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644)),
+          _samples(samples), _reporter(reporter)
+    {
+    }
+
+    Progress(const Progress &) = delete;
+    Progress &operator=(const Progress &) = delete;
+
+    ~Progress()
+    {
+        if (_journal >= 0)
+        {
+            close(_journal);
+        }
+    }
+
+    void started(const TestResult &result) const
+    {
+        if (_journal >= 0 && result.nanoseconds.empty())
+        {
+            std::string &started = line();
+            started += "started ";
+            started += result.name;
+            started += '\n';
+            append(started);
+        }
+    }
+
+    void finished(const TestResult &result) const
+    {
+        if ((_journal < 0 && !_reporter) || (result.nanoseconds.size() < _samples && result.outcome == Outcome::Passed))
+        {
+            return;
+        }
+
+        const double nanoseconds = result.nanoseconds.size() < 2 ? (result.nanoseconds.empty() ? 0 : result.nanoseconds[0])
+                                                                 : median(result.nanoseconds);
+
+        if (_journal >= 0)
+        {
+            std::string &finished = line();
+            finished += "finished ";
+            finished += result.name;
+            finished += ' ';
+            finished += describe(result.outcome);
+            finished += ' ';
+            appendNumber(finished, static_cast<long long>(nanoseconds + 0.5));
+            finished += '\n';
+            append(finished);
+        }
+
+        if (_reporter)
+        {
+            _reporter->report(ReportRecord{result.name.c_str(), result.outcome, nanoseconds, result.nanoseconds.size(),
+                                           result.instructions});
+        }
+    }
+};
+} // namespace DidYouKnow
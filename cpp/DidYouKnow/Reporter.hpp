@@ -0,0 +1,373 @@
+#pragma once
+
+#include "Numbers.hpp"
+#include "Result.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace DidYouKnow
+{
+/**
+ * A bounded queue that any number of threads may push to, and one thread
+ * pops from, without locks, after Dmitry Vyukov's design.  Each cell holds
+ * a sequence number that says whether it is ready to be written or read,
+ * so producers only contend on claiming a position.
+ */
+template <typename T>
+class MpscQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask;
+    alignas(64) std::atomic<size_t> _tail;
+    alignas(64) size_t _head;
+
+  public:
+    /**
+     * The capacity is rounded up to a power of two
+     */
+    explicit MpscQueue(const size_t capacity) : _tail(0), _head(0)
+    {
+        size_t rounded = 1;
+
+        while (rounded < capacity)
+        {
+            rounded *= 2;
+        }
+
+        _cells.reset(new Cell[rounded]);
+        _mask = rounded - 1;
+
+        for (size_t i = 0; i < rounded; ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * Returns false, rather than waiting, when the queue is full
+     */
+    bool tryPush(const T &value)
+    {
+        size_t position = _tail.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Cell &cell = _cells[position & _mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Only ever called from the one consuming thread
+     */
+    bool tryPop(T &value)
+    {
+        Cell &cell = _cells[_head & _mask];
+
+        if (cell.sequence.load(std::memory_order_acquire) != _head + 1)
+        {
+            return false;
+        }
+
+        value = cell.value;
+        cell.sequence.store(_head + _mask + 1, std::memory_order_release);
+        ++_head;
+        return true;
+    }
+};
+
+/**
+ * The result of one test, as reported.  Names are not copied, so must
+ * outlive the Reporter, as the names of the runner's results do.
+ */
+struct ReportRecord
+{
+    const char *name;
+    Outcome outcome;
+    double nanoseconds;
+    size_t samples;
+    long long instructions;
+};
+
+struct ReportSummary
+{
+    size_t passed;
+    size_t failed;
+    size_t timedOut;
+    double nanoseconds;
+
+    size_t total() const
+    {
+        return passed + failed + timedOut;
+    }
+};
+
+/**
+ * Writes test results as JSON Lines and as JUnit XML, from a background
+ * thread, so the threads reporting them only ever copy a record into a
+ * lock-free queue.  The writer drains the queue in batches, writing each
+ * batch out once the queue is empty, rather than flushing for each
+ * record, so a run that ends early leaves all but its last moments
+ * reported.  The JUnit file is kept whole after every batch: its header,
+ * padded to a fixed width, is rewritten with the counts so far, and its
+ * closing tags are written again after the latest test cases.
+ * Either path may be empty, to skip that format.
+ */
+class Reporter
+{
+    static const size_t BufferSize = 1 << 16;
+    static const size_t HeaderSize = 256;
+
+    MpscQueue<ReportRecord> _queue;
+    std::FILE *_jsonLines;
+    std::FILE *_junit;
+    long _junitEnd;
+    std::string _jsonLinesBuffer;
+    std::string _testCases;
+    ReportSummary _summary;
+    std::atomic<bool> _closing;
+    std::thread _writer;
+
+    static void appendEscaped(std::string &out, const char *text, const bool xml)
+    {
+        for (; *text; ++text)
+        {
+            switch (*text)
+            {
+            case '"':
+                out += xml ? "&quot;" : "\\\"";
+                break;
+            case '\\':
+                out += xml ? "\\" : "\\\\";
+                break;
+            case '<':
+                out += xml ? "&lt;" : "<";
+                break;
+            case '>':
+                out += xml ? "&gt;" : ">";
+                break;
+            case '&':
+                out += xml ? "&amp;" : "&";
+                break;
+            default:
+                if (static_cast<unsigned char>(*text) < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), xml ? "&#x%X;" : "\\u%04x", static_cast<unsigned>(*text));
+                    out += code;
+                }
+                else
+                {
+                    out += *text;
+                }
+            }
+        }
+    }
+
+    static void appendSeconds(std::string &out, const double nanoseconds)
+    {
+        char digits[48];
+        out.append(digits, std::to_chars(digits, digits + sizeof(digits), nanoseconds / 1e9, std::chars_format::fixed, 9).ptr);
+    }
+
+    void write(const ReportRecord &record)
+    {
+        if (_jsonLines)
+        {
+            _jsonLinesBuffer += "{\"name\":\"";
+            appendEscaped(_jsonLinesBuffer, record.name, false);
+            _jsonLinesBuffer += "\",\"outcome\":\"";
+            _jsonLinesBuffer += describe(record.outcome);
+            _jsonLinesBuffer += "\",\"nanoseconds\":";
+            appendNumber(_jsonLinesBuffer, static_cast<long long>(record.nanoseconds + 0.5));
+            _jsonLinesBuffer += ",\"samples\":";
+            appendNumber(_jsonLinesBuffer, record.samples);
+            _jsonLinesBuffer += ",\"instructions\":";
+            appendNumber(_jsonLinesBuffer, record.instructions);
+            _jsonLinesBuffer += "}\n";
+
+            if (_jsonLinesBuffer.size() >= BufferSize)
+            {
+                std::fwrite(_jsonLinesBuffer.data(), 1, _jsonLinesBuffer.size(), _jsonLines);
+                _jsonLinesBuffer.clear();
+            }
+        }
+
+        if (_junit)
+        {
+            _testCases += "    <testcase classname=\"DidYouKnow\" name=\"";
+            appendEscaped(_testCases, record.name, true);
+            _testCases += "\" time=\"";
+            appendSeconds(_testCases, record.nanoseconds);
+            _testCases += '"';
+            _testCases += record.outcome == Outcome::Passed   ? "/>\n"
+                          : record.outcome == Outcome::Failed ? ">\n      <failure message=\"failed\"/>\n    </testcase>\n"
+                                                              : ">\n      <error message=\"timed out\"/>\n    </testcase>\n";
+        }
+
+        ++(record.outcome == Outcome::Passed   ? _summary.passed
+           : record.outcome == Outcome::Failed ? _summary.failed
+                                               : _summary.timedOut);
+        _summary.nanoseconds += record.nanoseconds;
+    }
+
+    /**
+     * Writes out everything written since the last batch, leaving both
+     * files complete
+     */
+    void flush()
+    {
+        if (_jsonLines)
+        {
+            std::fwrite(_jsonLinesBuffer.data(), 1, _jsonLinesBuffer.size(), _jsonLines);
+            std::fflush(_jsonLines);
+            _jsonLinesBuffer.clear();
+        }
+
+        if (_junit)
+        {
+            char header[HeaderSize + 1];
+            const int length = std::snprintf(header, sizeof(header),
+                                             "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                             "<testsuites>\n  <testsuite name=\"DidYouKnow\" tests=\"%zu\" failures=\"%zu\" errors=\"%zu\" time=\"%.9f\"",
+                                             _summary.total(), _summary.failed, _summary.timedOut, _summary.nanoseconds / 1e9);
+            const std::string padded = std::string(header, std::min<size_t>(length, HeaderSize - 2)) +
+                                       std::string(HeaderSize - 2 - std::min<size_t>(length, HeaderSize - 2), ' ') + ">\n";
+            std::fseek(_junit, 0, SEEK_SET);
+            std::fwrite(padded.data(), 1, padded.size(), _junit);
+            std::fseek(_junit, _junitEnd, SEEK_SET);
+            std::fwrite(_testCases.data(), 1, _testCases.size(), _junit);
+            _junitEnd += static_cast<long>(_testCases.size());
+            _testCases.clear();
+            std::fputs("  </testsuite>\n</testsuites>\n", _junit);
+            std::fflush(_junit);
+        }
+    }
+
+    void drain()
+    {
+        for (;;)
+        {
+            const bool closing = _closing.load(std::memory_order_acquire);
+            ReportRecord record;
+            size_t written = 0;
+
+            while (_queue.tryPop(record))
+            {
+                write(record);
+                ++written;
+            }
+
+            if (written)
+            {
+                flush();
+            }
+
+            if (closing)
+            {
+                return;
+            }
+
+            if (!written)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+  public:
+    Reporter(const std::string &jsonLinesPath, const std::string &junitPath, const size_t capacity = 4096)
+        : _queue(capacity),
+          _jsonLines(jsonLinesPath.empty() ? nullptr : std::fopen(jsonLinesPath.c_str(), "w")),
+          _junit(junitPath.empty() ? nullptr : std::fopen(junitPath.c_str(), "w")),
+          _junitEnd(HeaderSize), _summary(), _closing(false)
+    {
+        _jsonLinesBuffer.reserve(BufferSize + 256);
+        flush();
+        _writer = std::thread(&Reporter::drain, this);
+    }
+
+    Reporter(const Reporter &) = delete;
+    Reporter &operator=(const Reporter &) = delete;
+
+    ~Reporter()
+    {
+        close();
+    }
+
+    /**
+     * Safe to call from any number of threads at once, only waiting
+     * when the writer has fallen a whole queue behind
+     */
+    void report(const ReportRecord &record)
+    {
+        while (!_queue.tryPush(record))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Writes whatever is left, then returns totals over every record
+     */
+    ReportSummary close()
+    {
+        if (!_writer.joinable())
+        {
+            return _summary;
+        }
+
+        _closing.store(true, std::memory_order_release);
+        _writer.join();
+
+        for (std::FILE **file : {&_jsonLines, &_junit})
+        {
+            if (*file)
+            {
+                std::fclose(*file);
+                *file = nullptr;
+            }
+        }
+
+        return _summary;
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace DidYouKnow
+{
+enum class Outcome
+{
+    Passed,
+    Failed,
+    TimedOut
+};
+
+inline const char *describe(const Outcome outcome)
+{
+    return outcome == Outcome::Passed   ? "passed"
+           : outcome == Outcome::Failed ? "failed"
+                                        : "timedOut";
+}
+
+/**
+ * What the runner learned from running a single test one or more times
+ */
+struct TestResult
+{
+    std::string name;
+    std::vector<double> nanoseconds;
+    long long instructions;
+    Outcome outcome;
+
+    explicit TestResult(const std::string &testName) : name(testName), instructions(-1), outcome(Outcome::Passed) {}
+};
+} // namespace DidYouKnow
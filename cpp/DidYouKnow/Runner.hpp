@@ -0,0 +1,452 @@
+#pragma once
+
+#include "Coverage.hpp"
+#include "EventLoop.hpp"
+#include "Fixture.hpp"
+#include "Forked.hpp"
+#include "History.hpp"
+#include "Impact.hpp"
+#include "Options.hpp"
+#include "Parameterised.hpp"
+#include "Profiler.hpp"
+#include "Progress.hpp"
+#include "Reporter.hpp"
+#include "Result.hpp"
+#include "Schedule.hpp"
+#include "Task.hpp"
+#include "Test.hpp"
+#include "Threaded.hpp"
+#include "Timing.hpp"
+#include "Watchdog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace DidYouKnow
+{
+inline Task timeAsyncTest(const AsyncTestFunction function, EventLoop &loop, TestResult &result)
+{
+    const Stopwatch::time_point started = Stopwatch::now();
+    co_await function(loop);
+    result.nanoseconds.push_back(nanosecondsSince(started));
+}
+
+inline void timeTest(const Test &test, const size_t index, TestResult &result, InstructionCounter &counter)
+{
+    Profiler::tag(static_cast<int>(index));
+    counter.start();
+    const Stopwatch::time_point started = Stopwatch::now();
+    test();
+    result.nanoseconds.push_back(nanosecondsSince(started));
+    const long long instructions = counter.stop();
+    Profiler::tag(Profiler::Runner);
+
+    if (instructions >= 0 && (result.instructions < 0 || instructions < result.instructions))
+    {
+        result.instructions = instructions;
+    }
+}
+
+/**
+ * Spawns the asynchronous tests onto a single EventLoop, so they are all in
+ * flight at once, and marks any that are still unfinished at the deadline
+ * as timed out
+ */
+inline void runAsync(const std::vector<Test> &tests, const std::vector<size_t> &indexes,
+                     std::vector<TestResult> &results, const EventLoop::Clock::time_point deadline)
+{
+    EventLoop loop;
+    std::vector<size_t> samples;
+
+    for (const size_t index : indexes)
+    {
+        samples.push_back(results[index].nanoseconds.size());
+        loop.spawn(timeAsyncTest(tests[index].asyncFunction, loop, results[index]));
+    }
+
+    Profiler::tag(Profiler::EventLoop);
+    const bool finished = loop.run(deadline);
+    Profiler::tag(Profiler::Runner);
+
+    for (size_t i = 0; !finished && i < indexes.size(); ++i)
+    {
+        if (results[indexes[i]].nanoseconds.size() == samples[i])
+        {
+            std::cerr << tests[indexes[i]].name << " timed out" << std::endl;
+            results[indexes[i]].outcome = Outcome::TimedOut;
+        }
+    }
+}
+
+/**
+ * Runs every test in a child process of its own, except for the
+ * asynchronous tests, which share one child, with up to the given number
+ * of children at once.  When several run at once, the asynchronous tests
+ * are started when the first of them is reached, rather than at the end.
+ */
+inline void runOnceForked(const std::vector<Test> &tests, std::vector<TestResult> &results, Watchdog &watchdog,
+                          const Progress &progress, const size_t jobs)
+{
+    std::vector<ForkedJob> forked;
+    std::vector<size_t> asyncTests;
+    size_t asyncJob = 0;
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        if (results[i].outcome != Outcome::Passed)
+        {
+            continue;
+        }
+
+        if (!tests[i].isAsync())
+        {
+            forked.push_back(ForkedJob{tests[i].name, {i}, 1, [&tests, &results, i](InstructionCounter &counter)
+                                       { timeTest(tests[i], i, results[i], counter); }});
+            continue;
+        }
+
+        if (asyncTests.empty())
+        {
+            asyncJob = jobs > 1 ? forked.size() : tests.size();
+        }
+
+        asyncTests.push_back(i);
+    }
+
+    if (!asyncTests.empty())
+    {
+        const EventLoop::Clock::time_point deadline = watchdog.deadline();
+        forked.insert(forked.begin() + std::min(asyncJob, forked.size()),
+                      ForkedJob{"The asynchronous tests", asyncTests, 2, [&tests, &asyncTests, &results, deadline](InstructionCounter &)
+                                { runAsync(tests, asyncTests, results, deadline); }});
+    }
+
+    runForked(forked, jobs, results, watchdog, progress);
+}
+
+/**
+ * Runs the synchronous tests in order, timing each one, then the
+ * asynchronous ones together, each within its time budget under the
+ * watchdog.  Tests that have already failed or timed out are not run again,
+ * nor, when they have been run on a pool of threads, are thread-safe ones.
+ */
+inline void runOnce(const std::vector<Test> &tests, std::vector<TestResult> &results, InstructionCounter &counter,
+                    Watchdog &watchdog, const Progress &progress, const bool threadSafeToo = true)
+{
+    std::vector<size_t> asyncTests;
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        if (results[i].outcome != Outcome::Passed || (tests[i].threadSafe && !tests[i].isAsync() && !threadSafeToo))
+        {
+            continue;
+        }
+
+        if (tests[i].isAsync())
+        {
+            asyncTests.push_back(i);
+        }
+        else
+        {
+            progress.started(results[i]);
+            watchdog.guard(tests[i].name, [&]()
+                           { timeTest(tests[i], i, results[i], counter); });
+            progress.finished(results[i]);
+        }
+    }
+
+    if (asyncTests.empty())
+    {
+        return;
+    }
+
+    for (const size_t index : asyncTests)
+    {
+        progress.started(results[index]);
+    }
+
+    const EventLoop::Clock::time_point deadline = watchdog.deadline();
+    watchdog.guard("The asynchronous tests", [&]()
+                   { runAsync(tests, asyncTests, results, deadline); }, 2);
+
+    for (const size_t index : asyncTests)
+    {
+        progress.finished(results[index]);
+    }
+}
+
+/**
+ * Runs the synchronous tests marked thread-safe on a pool of threads, then
+ * the rest one at a time on this thread, as a serial lane for those that
+ * share state
+ */
+inline void runOnceThreaded(const std::vector<Test> &tests, std::vector<TestResult> &results,
+                            InstructionCounter &counter, Watchdog &watchdog, const Progress &progress,
+                            const size_t threads)
+{
+    std::vector<size_t> pooled;
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        if (results[i].outcome == Outcome::Passed && tests[i].threadSafe && !tests[i].isAsync())
+        {
+            pooled.push_back(i);
+        }
+    }
+
+    runThreaded(tests, pooled, threads, results, watchdog, progress);
+    runOnce(tests, results, counter, watchdog, progress, false);
+}
+
+/**
+ * Runs every test as many times as asked, records their median timings,
+ * and fails the run if any test fails or runs out of time, or, when asked,
+ * is slower than its history.
+ * Tests that were already checked at compile time are only reported.
+ */
+inline int run(const std::vector<Test> &tests, const std::vector<const char *> &compileTimeTests,
+               const Options &options)
+{
+    std::vector<TestResult> results;
+    results.reserve(tests.size());
+
+    for (const Test &test : tests)
+    {
+        results.push_back(TestResult(test.name));
+    }
+
+    InstructionCounter counter;
+    std::unique_ptr<Reporter> reporter;
+
+    if (!options.jsonLinesPath.empty() || !options.junitPath.empty())
+    {
+        reporter.reset(new Reporter(options.jsonLinesPath, options.junitPath));
+    }
+
+    if (options.profile)
+    {
+        Profiler::start(options.profileHertz, 1 << 16);
+    }
+
+    {
+        Watchdog watchdog(options.timeout, options.globalTimeout);
+        const Progress progress(options.recordHistory ? Schedule::journalPath(options.schedulePath) : "", options.samples,
+                                reporter.get());
+
+        for (size_t sample = 0; sample < options.samples; ++sample)
+        {
+            if (options.fork)
+            {
+                runOnceForked(tests, results, watchdog, progress, options.jobs);
+            }
+            else if (options.threads > 1)
+            {
+                runOnceThreaded(tests, results, counter, watchdog, progress, options.threads);
+            }
+            else
+            {
+                runOnce(tests, results, counter, watchdog, progress);
+            }
+        }
+    }
+
+#ifdef DIDYOUKNOW_COVERAGE
+    if (Coverage::write(options.coverageIndex, tests))
+    {
+        std::cout << "Functions entered by each test written to " << options.coverageIndex << std::endl;
+    }
+    else
+    {
+        std::cerr << "Could not locate the functions entered, so " << options.coverageIndex
+                  << " was not written" << std::endl;
+    }
+#endif
+
+    if (options.list)
+    {
+        for (const char *name : compileTimeTests)
+        {
+            std::cout << "compile time  " << name << std::endl;
+        }
+
+        for (const Test &test : tests)
+        {
+            std::cout << "runtime       " << test.name << std::endl;
+        }
+    }
+
+    size_t passed = compileTimeTests.size();
+
+    for (const TestResult &result : results)
+    {
+        if (result.outcome == Outcome::Failed)
+        {
+            std::cerr << result.name << " failed" << std::endl;
+        }
+        else if (result.outcome == Outcome::TimedOut)
+        {
+            std::cerr << result.name << " timed out" << std::endl;
+        }
+        else
+        {
+            ++passed;
+        }
+    }
+
+    const size_t total = tests.size() + compileTimeTests.size();
+
+    if (passed == total)
+    {
+        std::cout << total << " tests passed successfully!" << std::endl;
+    }
+    else
+    {
+        std::cout << passed << " of " << total << " tests passed" << std::endl;
+    }
+
+    std::cout << compileTimeTests.size() << " were checked at compile time, and "
+              << tests.size() << " at runtime" << std::endl;
+
+    if (const size_t cases = parameterisedCasesRun().load())
+    {
+        std::cout << cases << " parameterised cases ran within them" << std::endl;
+    }
+
+    reportFixtures(std::cout);
+
+    if (reporter)
+    {
+        const ReportSummary summary = reporter->close();
+        std::cout << summary.total() << " results, taking " << formatDuration(summary.nanoseconds)
+                  << " in all, written to " << (options.jsonLinesPath.empty() ? options.junitPath : options.jsonLinesPath)
+                  << (options.jsonLinesPath.empty() || options.junitPath.empty() ? "" : " and " + options.junitPath) << std::endl;
+    }
+
+    if (options.profile)
+    {
+        Profiler::stop();
+        std::vector<std::string> names;
+
+        for (const Test &test : tests)
+        {
+            names.push_back(test.name);
+        }
+
+        const size_t files = Profiler::write(options.profileDirectory, names);
+        std::cout << Profiler::samplesTaken() << " profile samples written as folded stacks for "
+                  << files << " tests to " << options.profileDirectory << std::endl;
+    }
+
+    const History history(options.historyPath);
+    int status = passed == total ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (options.compareBaseline)
+    {
+        const std::vector<Regression> regressions =
+            findRegressions(history.baseline(options.baselineRuns), results, options.thresholds);
+
+        for (const Regression &regression : regressions)
+        {
+            std::cerr << regression.test << " regressed: median "
+                      << formatDuration(regression.baselineNanoseconds) << " -> "
+                      << formatDuration(regression.currentNanoseconds) << " ("
+                      << std::showpos << static_cast<int>(100 * (regression.currentNanoseconds / regression.baselineNanoseconds - 1))
+                      << std::noshowpos << "%)" << std::endl;
+        }
+
+        if (!regressions.empty())
+        {
+            std::cerr << regressions.size() << " tests regressed against " << history.path() << std::endl;
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (options.recordHistory && !Schedule(options.schedulePath).record(results))
+    {
+        std::cerr << "Could not record outcomes to " << options.schedulePath << std::endl;
+    }
+
+    if (status == EXIT_SUCCESS && options.recordHistory && !options.profile)
+    {
+        const unsigned long long run = std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::system_clock::now().time_since_epoch())
+                                           .count();
+
+        if (!history.append(run, results))
+        {
+            std::cerr << "Could not record timings to " << history.path() << std::endl;
+        }
+    }
+
+    return status;
+}
+
+inline int run(const std::vector<Test> &tests, const std::vector<const char *> &compileTimeTests,
+               const int argc, char *argv[])
+{
+    Options options;
+
+    try
+    {
+        options = Options::parse(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << e.what() << std::endl
+                  << Options::usage();
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Test> selected = options.changedSince.empty()
+                                           ? tests
+                                           : affectedTests(tests, options.changedSince, options.coverageIndex, std::cout);
+
+    // The records are only read when there is a journal to recover, or tests to order from them
+    if (options.recordHistory && Schedule::interrupted(options.schedulePath))
+    {
+        if (const size_t recovered = Schedule(options.schedulePath).recover())
+        {
+            std::cout << "Recovered the outcomes of " << recovered << " tests from a run that ended early, counting "
+                      << "those it never finished as failed" << std::endl;
+        }
+    }
+
+    if (!options.replayOrder.empty())
+    {
+        std::vector<Test> replayed;
+
+        if (!replayOrder(selected, options.replayOrder, replayed))
+        {
+            std::cerr << "Could not read the order to replay from " << options.replayOrder << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        return run(replayed, compileTimeTests, options);
+    }
+
+    if (options.registeredOrder)
+    {
+        return run(selected, compileTimeTests, options);
+    }
+
+    const Schedule schedule(options.schedulePath);
+    const std::vector<Test> ordered = schedule.order(selected, options.seed, options.jobs > 1 || options.threads > 1);
+    const std::string orderPath = Schedule::orderPath(options.schedulePath);
+    std::cout << "Ordered from " << schedule.path() << ", digest " << std::hex << schedule.digest() << std::dec
+              << ", with seed " << options.seed;
+
+    if (saveOrder(ordered, orderPath))
+    {
+        std::cout << ", as saved to " << orderPath << " for --replay-order";
+    }
+
+    std::cout << std::endl;
+    return run(ordered, compileTimeTests, options);
+}
+} // namespace DidYouKnow
@@ -0,0 +1,377 @@
+#pragma once
+
+#include "Numbers.hpp"
+#include "Result.hpp"
+#include "Test.hpp"
+#include "Timing.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * What the scheduler remembers of a test between runs: how recently it
+ * failed, how often it has flipped between passing and failing, and how
+ * long it usually takes.  Old behaviour decays, so a test that has long
+ * since been fixed drifts back into place.
+ */
+struct TestRecord
+{
+    double failures;
+    double flakiness;
+    double nanoseconds;
+    bool lastPassed;
+
+    TestRecord() : failures(0), flakiness(0), nanoseconds(0), lastPassed(true) {}
+
+    double risk() const
+    {
+        return failures + flakiness;
+    }
+
+    void update(const TestResult &result)
+    {
+        const bool passed = result.outcome == Outcome::Passed;
+        failures = failures / 2 + (passed ? 0 : 1);
+        flakiness = flakiness * 0.9 + (passed != lastPassed ? 1 : 0);
+        lastPassed = passed;
+
+        if (!result.nanoseconds.empty())
+        {
+            const double latest = median(result.nanoseconds);
+            nanoseconds = nanoseconds ? 0.8 * nanoseconds + 0.2 * latest : latest;
+        }
+    }
+};
+
+/**
+ * Orders tests for the fastest feedback, from a small file of per-test
+ * records, one "test failures flakiness nanoseconds lastPassed" per line.
+ * Tests that recently failed, flip between passing and failing, or have
+ * never been seen run first, riskiest first.  The rest run shortest first
+ * when run one at a time, so as many as possible report early, or longest
+ * first when run in parallel, so no job is left running on its own at the
+ * end.  Ties are broken by a shuffle from a seed, so an order is
+ * reproducible from the seed and the same records, which every run
+ * rewrites, so the order itself is saved for --replay-order too.
+ *
+ * Records are saved once a run ends, from its results, and a run that
+ * ends early, as one in process does on a failed assertion, leaves a
+ * journal of what it got to, which the next run recovers.
+ */
+class Schedule
+{
+    // Tests this risky are run before the rest
+    static constexpr double RiskThreshold = 0.1;
+
+    std::string _path;
+    std::map<std::string, TestRecord, std::less<>> _records;
+
+    /**
+     * Reads one saved line, in place rather than through a stream, as a
+     * suite of many tests has as many lines to read before it can start
+     */
+    static bool parse(const std::string &line, std::string &test, TestRecord &record)
+    {
+        const char *const last = line.data() + line.size();
+        const char *position = std::find(line.data(), last, ' ');
+        double lastPassed = 0;
+        test.assign(line.data(), position);
+
+        for (double *const field : {&record.failures, &record.flakiness, &record.nanoseconds, &lastPassed})
+        {
+            if (position == last || *position != ' ' || !(position = parseReal(position + 1, last, *field)))
+            {
+                return false;
+            }
+        }
+
+        record.lastPassed = lastPassed != 0;
+        return !test.empty();
+    }
+
+  public:
+    explicit Schedule(const std::string &path) : _path(path)
+    {
+        std::ifstream file(path.c_str());
+        std::string line, test;
+
+        while (std::getline(file, line))
+        {
+            TestRecord record;
+
+            if (parse(line, test, record))
+            {
+                // Saved in order, so each record goes at the end
+                _records.insert_or_assign(_records.end(), test, record);
+            }
+        }
+    }
+
+    const std::string &path() const
+    {
+        return _path;
+    }
+
+    /**
+     * Where a run journals its progress, for recover
+     */
+    static std::string journalPath(const std::string &path)
+    {
+        return path + ".journal";
+    }
+
+    /**
+     * Whether a run ended before it could record its results, leaving a
+     * journal to recover
+     */
+    static bool interrupted(const std::string &path)
+    {
+        return access(journalPath(path).c_str(), F_OK) == 0;
+    }
+
+    /**
+     * Where the order of the last scheduled run is saved
+     */
+    static std::string orderPath(const std::string &path)
+    {
+        return path + ".order";
+    }
+
+    /**
+     * The records as saved, one line per test, each number in its
+     * shortest form that reads back the same
+     */
+    std::string text() const
+    {
+        std::string text;
+
+        for (const auto &record : _records)
+        {
+            text += record.first;
+            text += ' ';
+            appendNumber(text, record.second.failures);
+            text += ' ';
+            appendNumber(text, record.second.flakiness);
+            text += ' ';
+            appendNumber(text, record.second.nanoseconds);
+            text += record.second.lastPassed ? " 1\n" : " 0\n";
+        }
+
+        return text;
+    }
+
+    /**
+     * A 64-bit FNV-1a hash of the records, to tell whether two runs were
+     * ordered from the same ones
+     */
+    unsigned long long digest() const
+    {
+        unsigned long long hash = 14695981039346656037ull;
+
+        for (const char c : text())
+        {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+
+        return hash;
+    }
+
+    std::vector<Test> order(const std::vector<Test> &tests, const unsigned long long seed, const bool longestFirst) const
+    {
+        // Each test's record is looked up once, not in every comparison
+        struct Key
+        {
+            size_t index;
+            double risk;
+            double nanoseconds;
+        };
+
+        std::vector<size_t> shuffled(tests.size());
+
+        for (size_t i = 0; i < shuffled.size(); ++i)
+        {
+            shuffled[i] = i;
+        }
+
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(seed));
+        std::vector<Key> keys;
+        keys.reserve(tests.size());
+
+        for (const size_t index : shuffled)
+        {
+            const auto record = _records.find(tests[index].name);
+            keys.push_back(record == _records.end() ? Key{index, 1 + RiskThreshold, 0}
+                                                    : Key{index, record->second.risk(), record->second.nanoseconds});
+        }
+
+        std::stable_sort(keys.begin(), keys.end(), [longestFirst](const Key &left, const Key &right)
+                         {
+            if ((left.risk >= RiskThreshold) != (right.risk >= RiskThreshold))
+            {
+                return left.risk >= RiskThreshold;
+            }
+
+            if (left.risk >= RiskThreshold && left.risk != right.risk)
+            {
+                return left.risk > right.risk;
+            }
+
+            return longestFirst ? left.nanoseconds > right.nanoseconds : left.nanoseconds < right.nanoseconds; });
+
+        std::vector<Test> ordered;
+        ordered.reserve(tests.size());
+
+        for (const Key &key : keys)
+        {
+            ordered.push_back(tests[key.index]);
+        }
+
+        return ordered;
+    }
+
+    /**
+     * Learns from the results of a run, then saves every record,
+     * including those of tests that did not run this time, and discards
+     * the run's journal
+     */
+    bool record(const std::vector<TestResult> &results)
+    {
+        for (const TestResult &result : results)
+        {
+            _records[result.name].update(result);
+        }
+
+        std::ofstream file(_path.c_str());
+        file << text();
+
+        if (!file.flush())
+        {
+            return false;
+        }
+
+        std::remove(journalPath(_path).c_str());
+        return true;
+    }
+
+    /**
+     * Learns from the journal of a run that ended before it could record
+     * its results, counting each test it started but never finished as
+     * failed, then saves.  Returns how many tests were recovered.
+     */
+    size_t recover()
+    {
+        std::ifstream journal(journalPath(_path).c_str());
+        std::vector<TestResult> results;
+        std::map<std::string, size_t> indexes;
+        std::string line;
+
+        while (std::getline(journal, line))
+        {
+            std::istringstream fields(line);
+            std::string kind, test, outcome;
+            double nanoseconds = 0;
+
+            if (!(fields >> kind >> test) || (kind != "started" && kind != "finished"))
+            {
+                continue;
+            }
+
+            if (!indexes.count(test))
+            {
+                indexes[test] = results.size();
+                results.push_back(TestResult(test));
+                results.back().outcome = Outcome::Failed;
+            }
+
+            TestResult &result = results[indexes[test]];
+
+            if (kind == "finished" && fields >> outcome >> nanoseconds)
+            {
+                result.outcome = outcome == "passed" ? Outcome::Passed : outcome == "timedOut" ? Outcome::TimedOut
+                                                                                               : Outcome::Failed;
+
+                if (nanoseconds > 0)
+                {
+                    result.nanoseconds.assign(1, nanoseconds);
+                }
+            }
+        }
+
+        if (results.empty() || !record(results))
+        {
+            return 0;
+        }
+
+        return results.size();
+    }
+};
+
+/**
+ * Saves the names of tests in the order they are to run, one per line
+ */
+inline bool saveOrder(const std::vector<Test> &tests, const std::string &path)
+{
+    std::ofstream file(path.c_str());
+
+    for (const Test &test : tests)
+    {
+        file << test.name << '\n';
+    }
+
+    return static_cast<bool>(file.flush());
+}
+
+/**
+ * Orders tests as saved by saveOrder, such as from a run in CI, with any
+ * tests it does not name after them, in the order given
+ */
+inline bool replayOrder(const std::vector<Test> &tests, const std::string &path, std::vector<Test> &ordered)
+{
+    std::ifstream file(path.c_str());
+
+    if (!file)
+    {
+        return false;
+    }
+
+    std::map<std::string, size_t> indexes;
+    std::vector<bool> placed(tests.size(), false);
+    std::string name;
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        indexes[tests[i].name] = i;
+    }
+
+    while (std::getline(file, name))
+    {
+        const auto index = indexes.find(name);
+
+        if (index != indexes.end() && !placed[index->second])
+        {
+            placed[index->second] = true;
+            ordered.push_back(tests[index->second]);
+        }
+    }
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        if (!placed[i])
+        {
+            ordered.push_back(tests[i]);
+        }
+    }
+
+    return true;
+}
+} // namespace DidYouKnow
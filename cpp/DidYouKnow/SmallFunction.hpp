@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace DidYouKnow
+{
+template <typename Signature, size_t Capacity = 4 * sizeof(void *)>
+class SmallFunction;
+
+/**
+ * A type-erased callable, much like std::function, except that whatever
+ * it wraps is always stored inline, so it never allocates.  Callables whose
+ * captures do not fit within the capacity are rejected at compile time.
+ * Trivially-copyable callables, such as function pointers and lambdas that
+ * capture by reference, are copied with a plain memcpy.
+ */
+template <typename Result, typename... Arguments, size_t Capacity>
+class SmallFunction<Result(Arguments...), Capacity>
+{
+    enum class Operation
+    {
+        Copy,
+        Destroy
+    };
+
+    alignas(std::max_align_t) unsigned char _storage[Capacity];
+    Result (*_invoke)(const void *, Arguments &&...);
+    void (*_manage)(Operation, void *, const void *);
+
+    template <typename Callable>
+    static Result invoke(const void *storage, Arguments &&...arguments)
+    {
+        return (*static_cast<const Callable *>(storage))(std::forward<Arguments>(arguments)...);
+    }
+
+    template <typename Callable>
+    static void manage(const Operation operation, void *destination, const void *source)
+    {
+        if (operation == Operation::Copy)
+        {
+            new (destination) Callable(*static_cast<const Callable *>(source));
+        }
+        else
+        {
+            static_cast<Callable *>(destination)->~Callable();
+        }
+    }
+
+    void copyFrom(const SmallFunction &other)
+    {
+        _invoke = other._invoke;
+        _manage = other._manage;
+
+        if (_manage)
+        {
+            _manage(Operation::Copy, _storage, other._storage);
+        }
+        else
+        {
+            std::memcpy(_storage, other._storage, Capacity);
+        }
+    }
+
+    void destroy()
+    {
+        if (_manage)
+        {
+            _manage(Operation::Destroy, _storage, nullptr);
+        }
+    }
+
+  public:
+    SmallFunction() : _invoke(nullptr), _manage(nullptr) {}
+
+    template <typename Callable,
+              typename = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, SmallFunction>::value>::type>
+    SmallFunction(Callable callable)
+    {
+        static_assert(sizeof(Callable) <= Capacity, "Captures too large for this SmallFunction: increase its Capacity");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Captures are over-aligned for SmallFunction");
+
+        new (_storage) Callable(std::move(callable));
+        _invoke = &invoke<Callable>;
+        _manage = std::is_trivially_copyable<Callable>::value ? nullptr : &manage<Callable>;
+    }
+
+    SmallFunction(const SmallFunction &other)
+    {
+        copyFrom(other);
+    }
+
+    SmallFunction &operator=(const SmallFunction &other)
+    {
+        if (this != &other)
+        {
+            destroy();
+            copyFrom(other);
+        }
+
+        return *this;
+    }
+
+    ~SmallFunction()
+    {
+        destroy();
+    }
+
+    explicit operator bool() const
+    {
+        return _invoke != nullptr;
+    }
+
+    Result operator()(Arguments... arguments) const
+    {
+        return _invoke(_storage, std::forward<Arguments>(arguments)...);
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * Epoch-based reclamation: each reading thread announces the epoch it
+ * started reading in, and anything retired in an epoch that no reader
+ * could still be in is safe to delete.  Announcing and leaving are plain
+ * atomic stores, so readers never wait on writers, nor on each other.
+ */
+class EpochDomain
+{
+    static const size_t MaximumThreads = 1024;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<unsigned long long> epoch{0};
+        std::atomic<bool> claimed{false};
+    };
+
+    std::atomic<unsigned long long> _epoch{1};
+    Slot _slots[MaximumThreads];
+
+    struct ThreadSlot
+    {
+        Slot *slot = nullptr;
+        size_t depth = 0;
+
+        ~ThreadSlot()
+        {
+            if (slot)
+            {
+                slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    ThreadSlot &threadSlot()
+    {
+        thread_local ThreadSlot threadSlot;
+
+        if (!threadSlot.slot)
+        {
+            for (Slot &slot : _slots)
+            {
+                bool unclaimed = false;
+
+                if (slot.claimed.compare_exchange_strong(unclaimed, true))
+                {
+                    threadSlot.slot = &slot;
+                    break;
+                }
+            }
+
+            if (!threadSlot.slot)
+            {
+                throw std::runtime_error("Too many threads are reading via EpochDomain");
+            }
+        }
+
+        return threadSlot;
+    }
+
+  public:
+    static EpochDomain &instance()
+    {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    void enter()
+    {
+        ThreadSlot &current = threadSlot();
+
+        if (current.depth++ == 0)
+        {
+            current.slot->epoch.store(_epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+        }
+    }
+
+    void leave()
+    {
+        ThreadSlot &current = threadSlot();
+
+        if (--current.depth == 0)
+        {
+            current.slot->epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Moves on to the next epoch, returning the one that has just ended
+     */
+    unsigned long long advance()
+    {
+        return _epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    /**
+     * Whether every reader that was reading in the given epoch has finished
+     */
+    bool quiescentSince(const unsigned long long epoch) const
+    {
+        for (const Slot &slot : _slots)
+        {
+            const unsigned long long reading = slot.epoch.load(std::memory_order_seq_cst);
+
+            if (reading != 0 && reading <= epoch)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+/**
+ * A map for data that is read constantly and written rarely, such as
+ * configuration, in the style of read-copy-update (RCU).  Readers take an
+ * immutable snapshot without locking; writers copy the current version,
+ * change the copy, then publish it, and old versions are deleted once no
+ * reader can still be looking at them.
+ */
+template <typename Key, typename Value, typename Map = std::map<Key, Value>>
+class SnapshotMap
+{
+    std::atomic<const Map *> _current;
+    std::mutex _writing;
+    std::vector<std::pair<unsigned long long, const Map *>> _retired;
+
+    void reclaim()
+    {
+        EpochDomain &domain = EpochDomain::instance();
+        size_t kept = 0;
+
+        for (size_t i = 0; i < _retired.size(); ++i)
+        {
+            if (domain.quiescentSince(_retired[i].first))
+            {
+                delete _retired[i].second;
+            }
+            else
+            {
+                _retired[kept++] = _retired[i];
+            }
+        }
+
+        _retired.resize(kept);
+    }
+
+  public:
+    /**
+     * A read-only view of one version of the map, which stays valid,
+     * and unchanged, for as long as it is held
+     */
+    class Snapshot
+    {
+        const Map *_map;
+
+      public:
+        explicit Snapshot(const std::atomic<const Map *> &current)
+        {
+            EpochDomain::instance().enter();
+            _map = current.load(std::memory_order_seq_cst);
+        }
+
+        Snapshot(const Snapshot &) = delete;
+        Snapshot &operator=(const Snapshot &) = delete;
+
+        ~Snapshot()
+        {
+            EpochDomain::instance().leave();
+        }
+
+        const Map &operator*() const
+        {
+            return *_map;
+        }
+
+        const Map *operator->() const
+        {
+            return _map;
+        }
+
+        const Value *find(const Key &key) const
+        {
+            const typename Map::const_iterator found = _map->find(key);
+            return found == _map->end() ? nullptr : &found->second;
+        }
+    };
+
+    explicit SnapshotMap(const Map &initial = Map()) : _current(new Map(initial)) {}
+
+    SnapshotMap(const SnapshotMap &) = delete;
+    SnapshotMap &operator=(const SnapshotMap &) = delete;
+
+    ~SnapshotMap()
+    {
+        for (const std::pair<unsigned long long, const Map *> &retired : _retired)
+        {
+            delete retired.second;
+        }
+
+        delete _current.load();
+    }
+
+    Snapshot snapshot() const
+    {
+        return Snapshot(_current);
+    }
+
+    std::optional<Value> get(const Key &key) const
+    {
+        const Snapshot current = snapshot();
+        const Value *found = current.find(key);
+        return found ? std::optional<Value>(*found) : std::nullopt;
+    }
+
+    /**
+     * Publishes a new version, made by applying a change to a copy of the
+     * current one, so that several changes can be published at once
+     */
+    template <typename Change>
+    void update(Change change)
+    {
+        const std::lock_guard<std::mutex> lock(_writing);
+        std::unique_ptr<Map> next(new Map(*_current.load(std::memory_order_relaxed)));
+        change(*next);
+
+        const Map *previous = _current.exchange(next.release(), std::memory_order_seq_cst);
+        _retired.push_back(std::make_pair(EpochDomain::instance().advance(), previous));
+        reclaim();
+    }
+
+    void set(const Key &key, const Value &value)
+    {
+        update([&](Map &map)
+               { map[key] = value; });
+    }
+
+    void erase(const Key &key)
+    {
+        update([&](Map &map)
+               { map.erase(key); });
+    }
+
+    size_t versionsAwaitingReclamation()
+    {
+        const std::lock_guard<std::mutex> lock(_writing);
+        reclaim();
+        return _retired.size();
+    }
+};
+} // namespace DidYouKnow
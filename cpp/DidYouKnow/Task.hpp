@@ -0,0 +1,131 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace DidYouKnow
+{
+/**
+ * A lazily-started coroutine that returns nothing, which may either be
+ * handed to an EventLoop to be driven, or awaited by another Task,
+ * in which case the awaiting Task is resumed once this one completes
+ */
+class Task
+{
+  public:
+    struct promise_type
+    {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr exception;
+
+        Task get_return_object()
+        {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                const std::coroutine_handle<> continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception()
+        {
+            exception = std::current_exception();
+        }
+    };
+
+    Task() : _handle(nullptr) {}
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    Task(Task &&other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy();
+            _handle = std::exchange(other._handle, nullptr);
+        }
+
+        return *this;
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task()
+    {
+        destroy();
+    }
+
+    std::coroutine_handle<> handle() const
+    {
+        return _handle;
+    }
+
+    bool done() const
+    {
+        return !_handle || _handle.done();
+    }
+
+    void rethrowIfFailed() const
+    {
+        if (_handle && _handle.promise().exception)
+        {
+            std::rethrow_exception(_handle.promise().exception);
+        }
+    }
+
+    bool await_ready() const noexcept
+    {
+        return done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        _handle.promise().continuation = awaiting;
+        return _handle;
+    }
+
+    void await_resume() const
+    {
+        rethrowIfFailed();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> _handle;
+
+    void destroy()
+    {
+        if (_handle)
+        {
+            _handle.destroy();
+        }
+    }
+};
+} // namespace DidYouKnow
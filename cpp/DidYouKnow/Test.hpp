@@ -0,0 +1,91 @@
+#pragma once
+
+#include "EventLoop.hpp"
+#include "SmallFunction.hpp"
+#include "Task.hpp"
+
+namespace DidYouKnow
+{
+typedef void (*TestFunction)();
+typedef Task (*AsyncTestFunction)(EventLoop &);
+typedef SmallFunction<void()> TestBody;
+
+/**
+ * A registered test, which is either a body that runs to completion,
+ * or a coroutine that is driven by an EventLoop.  Bodies may be plain
+ * functions, functions that take shared fixtures as parameters,
+ * or callables that capture the state they need.  Tests are assumed to
+ * share state, and so run one at a time, unless marked thread-safe.
+ */
+struct Test
+{
+    const char *name;
+    TestBody body;
+    AsyncTestFunction asyncFunction;
+    bool threadSafe;
+
+    Test(const char *testName, const TestFunction testFunction)
+        : name(testName), body(testFunction), asyncFunction(nullptr), threadSafe(false) {}
+
+    template <typename... Fixtures>
+    Test(const char *testName, void (*testFunction)(const Fixtures &...))
+        : name(testName), body([testFunction]()
+                               { testFunction(Fixtures::declared()...); }),
+          asyncFunction(nullptr), threadSafe(false) {}
+
+    template <typename Callable>
+    Test(const char *testName, Callable callable)
+        : name(testName), body(callable), asyncFunction(nullptr), threadSafe(false) {}
+
+    Test(const char *testName, const AsyncTestFunction testFunction)
+        : name(testName), asyncFunction(testFunction), threadSafe(false) {}
+
+    /**
+     * A copy of the test, marked as touching no state shared with other
+     * tests, so that it may run alongside them, on any thread
+     */
+    Test markedThreadSafe() const
+    {
+        Test marked(*this);
+        marked.threadSafe = true;
+        return marked;
+    }
+
+    bool isAsync() const
+    {
+        return asyncFunction != nullptr;
+    }
+
+    void operator()() const
+    {
+        body();
+    }
+};
+
+/**
+ * A test marked constexpr can be evaluated by the compiler, where any
+ * failing assertion stops it being a constant expression, so the build
+ * fails instead.  Only its name is left to be reported at runtime.
+ */
+template <void (*test)()>
+constexpr const char *checkedAtCompileTime(const char *name)
+{
+    static_assert((test(), true), "Test failed at compile time");
+    return name;
+}
+} // namespace DidYouKnow
+
+/**
+ * Registers a test under the name of its function, via stringification
+ */
+#define NAMED_TEST(test) DidYouKnow::Test(#test, &test)
+
+/**
+ * Registers a test that touches no shared state, so may run on any thread
+ */
+#define THREAD_SAFE_TEST(test) NAMED_TEST(test).markedThreadSafe()
+
+/**
+ * Checks a constexpr test at compile time, in place of registering it
+ */
+#define CONSTEXPR_TEST(test) DidYouKnow::checkedAtCompileTime<&test>(#test)
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Progress.hpp"
+#include "Result.hpp"
+#include "Test.hpp"
+#include "Timing.hpp"
+#include "Watchdog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+namespace DidYouKnow
+{
+/**
+ * One worker's share of a batch of work, as the items [top, bottom) of a
+ * list fixed up front.  The owner takes from the bottom and thieves take
+ * from the top, and both ends are packed into one word, so that a single
+ * compare-and-swap settles who gets each item, without a lock.  As nothing
+ * is added once the batch has started, there is none of the care a
+ * growable deque needs.
+ */
+class WorkRange
+{
+    alignas(64) std::atomic<uint64_t> _range;
+
+    static uint64_t pack(const uint32_t top, const uint32_t bottom)
+    {
+        return static_cast<uint64_t>(top) << 32 | bottom;
+    }
+
+    template <bool FromTop>
+    bool take(uint32_t &item)
+    {
+        uint64_t range = _range.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            const uint32_t top = static_cast<uint32_t>(range >> 32), bottom = static_cast<uint32_t>(range);
+
+            if (top >= bottom)
+            {
+                return false;
+            }
+
+            if (_range.compare_exchange_weak(range, FromTop ? pack(top + 1, bottom) : pack(top, bottom - 1),
+                                             std::memory_order_relaxed))
+            {
+                item = FromTop ? top : bottom - 1;
+                return true;
+            }
+        }
+    }
+
+  public:
+    WorkRange() : _range(0) {}
+
+    void assign(const uint32_t first, const uint32_t last)
+    {
+        _range.store(pack(first, last), std::memory_order_relaxed);
+    }
+
+    bool pop(uint32_t &item)
+    {
+        return take<false>(item);
+    }
+
+    bool steal(uint32_t &item)
+    {
+        return take<true>(item);
+    }
+};
+
+/**
+ * What each worker is running, and since when, for the main thread to
+ * check against the per-test budget.  The start is written before the
+ * test, so a reader that catches the two mid-update can only see a test
+ * as having run for less time than it has.
+ */
+struct alignas(64) WorkerState
+{
+    std::atomic<size_t> current{SIZE_MAX};
+    std::atomic<Stopwatch::rep> started{0};
+    pthread_t thread;
+};
+
+/**
+ * Runs tests on a pool of threads, in this process, each worker taking
+ * its own share of them and stealing from the others once that runs out.
+ * Shares are dealt in turn from the scheduled order, so each worker
+ * starts on its longest tests, and thieves take the shortest.
+ * Instructions are not counted, as the system calls that would take cost
+ * more than most of the tests run this way.  A test cannot be abandoned
+ * on a thread as it can on the main one, so one that overruns its budget
+ * has its stack dumped, and ends the run.
+ */
+inline void runThreaded(const std::vector<Test> &tests, const std::vector<size_t> &indexes, const size_t threads,
+                        std::vector<TestResult> &results, const Watchdog &watchdog, const Progress &progress)
+{
+    const size_t workers = std::min(threads, indexes.size());
+
+    if (workers == 0)
+    {
+        return;
+    }
+
+    // Each worker's share, held contiguously, with its first test last
+    std::vector<size_t> dealt;
+    std::unique_ptr<WorkRange[]> ranges(new WorkRange[workers]);
+    std::unique_ptr<WorkerState[]> states(new WorkerState[workers]);
+
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        const size_t first = dealt.size();
+
+        for (size_t i = worker; i < indexes.size(); i += workers)
+        {
+            dealt.push_back(indexes[i]);
+        }
+
+        std::reverse(dealt.begin() + first, dealt.end());
+        ranges[worker].assign(static_cast<uint32_t>(first), static_cast<uint32_t>(dealt.size()));
+    }
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t running = workers;
+    std::vector<std::thread> pool;
+
+    for (size_t worker = 0; worker < workers; ++worker)
+    {
+        pool.emplace_back([&, worker]()
+                          {
+            WorkerState &state = states[worker];
+            uint32_t item;
+
+            for (;;)
+            {
+                bool found = ranges[worker].pop(item);
+
+                for (size_t victim = (worker + 1) % workers; !found && victim != worker; victim = (victim + 1) % workers)
+                {
+                    found = ranges[victim].steal(item);
+                }
+
+                if (!found)
+                {
+                    break;
+                }
+
+                const size_t index = dealt[item];
+                const Stopwatch::time_point started = Stopwatch::now();
+                state.started.store(started.time_since_epoch().count(), std::memory_order_relaxed);
+                state.current.store(index, std::memory_order_release);
+                progress.started(results[index]);
+                tests[index]();
+                results[index].nanoseconds.push_back(nanosecondsSince(started));
+                progress.finished(results[index]);
+            }
+
+            state.current.store(SIZE_MAX, std::memory_order_release);
+            const std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            finished.notify_one(); });
+
+        states[worker].thread = pool.back().native_handle();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (!finished.wait_for(lock, std::chrono::milliseconds(10), [&]()
+                                  { return running == 0; }))
+        {
+            for (size_t worker = 0; watchdog.perTest().count() && worker < workers; ++worker)
+            {
+                const size_t index = states[worker].current.load(std::memory_order_acquire);
+                const Stopwatch::time_point started(Stopwatch::duration(states[worker].started.load(std::memory_order_relaxed)));
+
+                if (index != SIZE_MAX && Stopwatch::now() - started > watchdog.perTest())
+                {
+                    Watchdog::endRun(states[worker].thread, {tests[index].name, " timed out, and cannot be abandoned on a thread of the pool, so the run ends"});
+                }
+            }
+        }
+    }
+
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+}
+} // namespace DidYouKnow
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace DidYouKnow
+{
+typedef std::chrono::steady_clock Stopwatch;
+
+inline double nanosecondsSince(const Stopwatch::time_point started)
+{
+    return std::chrono::duration<double, std::nano>(Stopwatch::now() - started).count();
+}
+
+/**
+ * Counts the instructions retired by the calling thread, via the Linux
+ * perf_event interface.  Counts are reported as -1 wherever that is
+ * unavailable, such as on other platforms or in locked-down containers.
+ */
+class InstructionCounter
+{
+    int _fd;
+
+  public:
+    InstructionCounter() : _fd(-1)
+    {
+#ifdef __linux__
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        _fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    InstructionCounter(const InstructionCounter &) = delete;
+    InstructionCounter &operator=(const InstructionCounter &) = delete;
+
+    ~InstructionCounter()
+    {
+#ifdef __linux__
+        if (_fd >= 0)
+        {
+            close(_fd);
+        }
+#endif
+    }
+
+    bool available() const
+    {
+        return _fd >= 0;
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        if (_fd >= 0)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop()
+    {
+#ifdef __linux__
+        long long count = 0;
+
+        if (_fd >= 0 && ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0) == 0 && read(_fd, &count, sizeof(count)) == sizeof(count))
+        {
+            return count;
+        }
+#endif
+        return -1;
+    }
+};
+
+inline std::string formatDuration(const double nanoseconds)
+{
+    std::ostringstream formatted;
+    formatted << std::fixed << std::setprecision(1);
+
+    if (nanoseconds >= 1e6)
+    {
+        formatted << nanoseconds / 1e6 << "ms";
+    }
+    else if (nanoseconds >= 1e3)
+    {
+        formatted << nanoseconds / 1e3 << "us";
+    }
+    else
+    {
+        formatted << nanoseconds << "ns";
+    }
+
+    return formatted.str();
+}
+
+inline double median(std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+
+    const size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    const double upper = values[middle];
+
+    if (values.size() % 2)
+    {
+        return upper;
+    }
+
+    return (*std::max_element(values.begin(), values.begin() + middle) + upper) / 2;
+}
+
+/**
+ * The median absolute deviation, scaled so that it estimates the standard
+ * deviation of normally-distributed samples, while shrugging off the
+ * outliers that a busy machine inevitably produces
+ */
+inline double robustSpread(const std::vector<double> &values)
+{
+    const double centre = median(values);
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+
+    for (const double value : values)
+    {
+        deviations.push_back(std::fabs(value - centre));
+    }
+
+    return 1.4826 * median(deviations);
+}
+} // namespace DidYouKnow
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <initializer_list>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace DidYouKnow
+{
+/**
+ * Writes the stack of the calling thread to stderr, using only calls that
+ * are safe within a signal handler, once backtrace has been warmed up
+ */
+inline void dumpStack(const char *heading)
+{
+    void *frames[64];
+    const int depth = backtrace(frames, 64);
+    const ssize_t written = write(STDERR_FILENO, heading, std::strlen(heading));
+    static_cast<void>(written);
+    backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+}
+
+/**
+ * Enforces time budgets from a thread of its own: one for each test, and
+ * one for the whole run.  When either overruns, the thread running the
+ * test is sent SIGUSR1, whose handler dumps its stack and ends the
+ * process.  A test cannot be abandoned within the process, as it may hold
+ * a lock, such as malloc's, that nothing would then release, so to carry
+ * on past a test that hangs, run each test in a child process of its own,
+ * via --fork, where the child is the one that ends.
+ */
+class Watchdog
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+  private:
+    std::chrono::milliseconds _perTest;
+    Clock::time_point _globalDeadline;
+    pthread_t _runner;
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::string _activity;
+    Clock::time_point _deadline;
+    bool _watching;
+    bool _stopping;
+    std::thread _thread;
+
+    static void onSignal(int)
+    {
+        dumpStack("Stack of the test that overran:\n");
+        _exit(EXIT_FAILURE);
+    }
+
+    void watch()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while (!_stopping)
+        {
+            const Clock::time_point deadline = _watching ? std::min(_deadline, _globalDeadline) : _globalDeadline;
+
+            if (deadline == Clock::time_point::max())
+            {
+                _changed.wait(lock);
+                continue;
+            }
+
+            if (Clock::now() < deadline)
+            {
+                _changed.wait_until(lock, deadline);
+                continue;
+            }
+
+            if (Clock::now() >= _globalDeadline)
+            {
+                endRun(_runner, {"Global time budget exhausted", _watching ? " during " : "", _watching ? _activity.c_str() : ""});
+            }
+
+            endRun(_runner, {_activity.c_str(), " timed out, and cannot be abandoned in process, as it may hold a lock, "
+                                                "so the run ends; run with --fork to carry on past it"});
+        }
+    }
+
+    void begin(const std::string &activity, const Clock::time_point deadline)
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _activity = activity;
+        _deadline = deadline;
+        _watching = true;
+        _changed.notify_one();
+    }
+
+    void end()
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _watching = false;
+    }
+
+  public:
+    /**
+     * A zero budget is no budget at all
+     */
+    Watchdog(const std::chrono::milliseconds perTest, const std::chrono::milliseconds global)
+        : _perTest(perTest),
+          _globalDeadline(global.count() ? Clock::now() + global : Clock::time_point::max()),
+          _runner(pthread_self()), _watching(false), _stopping(false)
+    {
+        installHandler();
+        _thread = std::thread(&Watchdog::watch, this);
+    }
+
+    Watchdog(const Watchdog &) = delete;
+    Watchdog &operator=(const Watchdog &) = delete;
+
+    ~Watchdog()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+            _changed.notify_one();
+        }
+
+        _thread.join();
+    }
+
+    /**
+     * The time allowed for each test, or zero for no limit
+     */
+    std::chrono::milliseconds perTest() const
+    {
+        return _perTest;
+    }
+
+    /**
+     * When something started now, and allowed the given number of per-test
+     * budgets, must finish, taking the global budget into account
+     */
+    Clock::time_point deadline(const int budgets = 1) const
+    {
+        const Clock::time_point now = Clock::now();
+
+        if (!_perTest.count() || _globalDeadline - now < budgets * _perTest)
+        {
+            return _globalDeadline;
+        }
+
+        return now + budgets * _perTest;
+    }
+
+    /**
+     * Installed before any test runs, so forked children inherit it, and
+     * are ended by it when killed for overrunning
+     */
+    static void installHandler()
+    {
+        void *warmUp[1];
+        backtrace(warmUp, 1);
+
+        struct sigaction action = {};
+        action.sa_handler = &onSignal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGUSR1, &action, nullptr);
+    }
+
+    /**
+     * Says why the run is ending, then has the thread that overran dump its
+     * stack and end the process, ending it from here should that not have
+     * happened within a second.  Nothing here allocates or takes a lock, as
+     * the thread that overran may be holding one.
+     */
+    [[noreturn]] static void endRun(const pthread_t thread, const std::initializer_list<const char *> message)
+    {
+        for (const char *part : message)
+        {
+            const ssize_t written = write(STDERR_FILENO, part, std::strlen(part));
+            static_cast<void>(written);
+        }
+
+        const ssize_t written = write(STDERR_FILENO, "\n", 1);
+        static_cast<void>(written);
+        pthread_kill(thread, SIGUSR1);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        _exit(EXIT_FAILURE);
+    }
+
+    /**
+     * Runs a body within the given number of per-test budgets, ending the
+     * run if it overruns them
+     */
+    template <typename Body>
+    void guard(const std::string &activity, Body body, const int budgets = 1)
+    {
+        begin(activity, deadline(budgets));
+        body();
+        end();
+    }
+};
+} // namespace DidYouKnow
@@ -0,0 +1,192 @@
+// Indexing is measured as release builds see it, without bounds checks
+#define NDEBUG
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "DidYouKnow/AlignedBuffer.hpp"
+#include "DidYouKnow/Benchmark.hpp"
+
+/**
+ * Measures the same element-wise loops over plain arrays, std::vector and
+ * AlignedBuffer, as the compiler vectorises them, against the dispatched
+ * kernels of AlignedBuffer.hpp at each instruction set this processor
+ * supports, for buffers that fit in the first level of cache, and for
+ * buffers large enough to be mapped to huge pages, where memory bandwidth
+ * decides
+ */
+
+/**
+ * Each of a, b and c as one kind of storage, with an output and indexes
+ * to gather through
+ */
+template <typename Floats, typename Indexes>
+struct Operands
+{
+    Floats a, b, c, out;
+    Indexes indexes;
+    DidYouKnow::IndexBuffer greater;
+};
+
+template <typename Floats>
+__attribute__((noinline)) void loopAdd(const Floats &a, const Floats &b, Floats &out, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[i] = a[i] + b[i];
+    }
+}
+
+template <typename Floats>
+__attribute__((noinline)) void loopScale(const Floats &a, const float factor, Floats &out, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[i] = a[i] * factor;
+    }
+}
+
+template <typename Floats>
+__attribute__((noinline)) void loopMultiplyAdd(const Floats &a, const Floats &b, const Floats &c, Floats &out,
+                                               const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[i] = a[i] * b[i] + c[i];
+    }
+}
+
+template <typename Floats>
+__attribute__((noinline)) void loopGreater(const Floats &a, const Floats &b, DidYouKnow::IndexBuffer &out,
+                                           const size_t size)
+{
+    int32_t *const results = out.data();
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        results[i] = a[i] > b[i];
+    }
+}
+
+template <typename Floats, typename Indexes>
+__attribute__((noinline)) void loopGather(const Floats &a, const Indexes &indexes, Floats &out, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        out[i] = a[indexes[i]];
+    }
+}
+
+/**
+ * Times each loop over one kind of storage, filled from the same values
+ */
+template <typename Floats, typename Indexes>
+void measureLoops(DidYouKnow::BenchmarkTable &table, const char *storage, Operands<Floats, Indexes> &operands,
+                  const size_t size, const size_t iterations)
+{
+    Operands<Floats, Indexes> &o = operands;
+    const std::string length = std::to_string(size);
+
+    table.add({"add", length, storage}, {table.time(iterations, [&]()
+                                                    { loopAdd(o.a, o.b, o.out, size); }) /
+                                         size});
+    table.add({"scale", length, storage}, {table.time(iterations, [&]()
+                                                      { loopScale(o.a, 1.5f, o.out, size); }) /
+                                           size});
+    table.add({"multiply-add", length, storage}, {table.time(iterations, [&]()
+                                                             { loopMultiplyAdd(o.a, o.b, o.c, o.out, size); }) /
+                                                  size});
+    table.add({"greater", length, storage}, {table.time(iterations, [&]()
+                                                        { loopGreater(o.a, o.b, o.greater, size); }) /
+                                             size});
+    table.add({"gather", length, storage}, {table.time(iterations, [&]()
+                                                       { loopGather(o.a, o.indexes, o.out, size); }) /
+                                            size});
+}
+
+void measure(DidYouKnow::BenchmarkTable &table, const size_t size, const size_t iterations)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> values(-1, 1);
+
+    Operands<DidYouKnow::FloatBuffer, DidYouKnow::IndexBuffer> aligned{
+        DidYouKnow::FloatBuffer(size), DidYouKnow::FloatBuffer(size), DidYouKnow::FloatBuffer(size),
+        DidYouKnow::FloatBuffer(size), DidYouKnow::IndexBuffer(size), DidYouKnow::IndexBuffer(size)};
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        aligned.a[i] = values(random);
+        aligned.b[i] = values(random);
+        aligned.c[i] = values(random);
+        aligned.indexes[i] = static_cast<int32_t>(random() % size);
+    }
+
+    // Offset by one element, as nothing promises an array more than its type's alignment
+    std::vector<std::unique_ptr<float[]>> owned;
+    const auto array = [&](const DidYouKnow::FloatBuffer &from)
+    {
+        owned.emplace_back(new float[size + 1]);
+        std::copy(from.begin(), from.end(), owned.back().get() + 1);
+        return owned.back().get() + 1;
+    };
+
+    std::unique_ptr<int32_t[]> arrayIndexes(new int32_t[size]);
+    std::copy(aligned.indexes.begin(), aligned.indexes.end(), arrayIndexes.get());
+    Operands<float *, int32_t *> arrays{array(aligned.a), array(aligned.b), array(aligned.c),
+                                        array(aligned.out), arrayIndexes.get(), DidYouKnow::IndexBuffer(size)};
+
+    const auto vector = [](const DidYouKnow::FloatBuffer &from)
+    {
+        return std::vector<float>(from.begin(), from.end());
+    };
+
+    Operands<std::vector<float>, std::vector<int32_t>> vectors{
+        vector(aligned.a), vector(aligned.b), vector(aligned.c), vector(aligned.out),
+        std::vector<int32_t>(aligned.indexes.begin(), aligned.indexes.end()), DidYouKnow::IndexBuffer(size)};
+
+    measureLoops(table, "array", arrays, size, iterations);
+    measureLoops(table, "std::vector", vectors, size, iterations);
+    measureLoops(table, "AlignedBuffer", aligned, size, iterations);
+
+    for (const DidYouKnow::SimdLevel level : {DidYouKnow::SimdLevel::Scalar, DidYouKnow::SimdLevel::Sse, DidYouKnow::SimdLevel::Avx2})
+    {
+        if (level > DidYouKnow::bestSimd())
+        {
+            continue;
+        }
+
+        Operands<DidYouKnow::FloatBuffer, DidYouKnow::IndexBuffer> &o = aligned;
+        const std::string storage = std::string(DidYouKnow::simdName(level)) + " kernel";
+        const std::string length = std::to_string(size);
+
+        table.add({"add", length, storage}, {table.time(iterations, [&]()
+                                                        { DidYouKnow::add(o.a, o.b, o.out, level); }) /
+                                             size});
+        table.add({"scale", length, storage}, {table.time(iterations, [&]()
+                                                          { DidYouKnow::scale(o.a, 1.5f, o.out, level); }) /
+                                               size});
+        table.add({"multiply-add", length, storage}, {table.time(iterations, [&]()
+                                                                 { DidYouKnow::multiplyAdd(o.a, o.b, o.c, o.out, level); }) /
+                                                      size});
+        table.add({"greater", length, storage}, {table.time(iterations, [&]()
+                                                            { DidYouKnow::greater(o.a, o.b, o.greater, level); }) /
+                                                 size});
+        table.add({"gather", length, storage}, {table.time(iterations, [&]()
+                                                           { DidYouKnow::gather(o.a, o.indexes, o.out, level); }) /
+                                                size});
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    DidYouKnow::BenchmarkTable table({"kernel", "elements", "storage"}, {"ns/element"});
+
+    measure(table, 4096, 20000);
+    measure(table, 4 << 20, 20);
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/CreateContainer.hpp"
+
+/**
+ * Measures what the choice of container passed to CreateContainer costs,
+ * to build one element at a time, iterate, copy out via get() and destroy,
+ * across element types and sizes, in nanoseconds per element.  Sizes
+ * whose elements would take more than --max-bytes are skipped, from the
+ * footprint of a sample, all three copies of which are alive at once, as
+ * measured by replacing the global operator new, so it counts what each
+ * string holds on the heap and each node of a list besides the element.
+ */
+
+// Only counted while sampling a footprint, so the timed runs pay no more than a branch
+bool countingBytes = false;
+size_t liveBytes = 0;
+
+// Kept out of line, so GCC does not see free() called on what operator new returned, and warn
+__attribute__((noinline)) void *allocate(const size_t size)
+{
+    if (void *allocated = std::malloc(size ? size : 1))
+    {
+        if (countingBytes)
+        {
+            liveBytes += malloc_usable_size(allocated);
+        }
+
+        return allocated;
+    }
+
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void release(void *allocated) noexcept
+{
+    if (countingBytes && allocated)
+    {
+        liveBytes -= malloc_usable_size(allocated);
+    }
+
+    std::free(allocated);
+}
+
+void *operator new(const size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](const size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *allocated) noexcept
+{
+    release(allocated);
+}
+
+void operator delete[](void *allocated) noexcept
+{
+    release(allocated);
+}
+
+void operator delete(void *allocated, size_t) noexcept
+{
+    release(allocated);
+}
+
+void operator delete[](void *allocated, size_t) noexcept
+{
+    release(allocated);
+}
+
+struct LargeStruct
+{
+    long values[32];
+
+    LargeStruct(const long value = 0)
+    {
+        for (long &element : values)
+        {
+            element = value;
+        }
+    }
+};
+
+template <typename T>
+T makeElement(size_t i);
+
+template <>
+int makeElement<int>(const size_t i)
+{
+    return static_cast<int>(i);
+}
+
+template <>
+std::string makeElement<std::string>(const size_t i)
+{
+    return "longer than the small string buffer " + std::to_string(i);
+}
+
+template <>
+LargeStruct makeElement<LargeStruct>(const size_t i)
+{
+    return LargeStruct(static_cast<long>(i));
+}
+
+inline size_t weigh(const int value)
+{
+    return static_cast<size_t>(value);
+}
+
+inline size_t weigh(const std::string &value)
+{
+    return value.size();
+}
+
+inline size_t weigh(const LargeStruct &value)
+{
+    return static_cast<size_t>(value.values[0]);
+}
+
+/**
+ * Promotes the protected container, as testChangingScope demonstrates,
+ * so it can be iterated without first being copied out
+ */
+template <template <class, class> class V, class T>
+struct ExposesContainer : DidYouKnow::CreateContainer<V, T>
+{
+    using DidYouKnow::CreateContainer<V, T>::_container;
+};
+
+template <typename T>
+std::vector<T> makeElements(const size_t size)
+{
+    std::vector<T> made;
+    made.reserve(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        made.push_back(makeElement<T>(i));
+    }
+
+    return made;
+}
+
+/**
+ * The heap bytes each element takes while measured, with the elements
+ * made, the container built from them and the copy get() makes all alive
+ */
+template <template <class, class> class V, class T>
+double bytesPerElement(const size_t size)
+{
+    const size_t sample = std::min<size_t>(size, 1000);
+    countingBytes = true;
+    liveBytes = 0;
+    double bytes;
+
+    {
+        const std::vector<T> elements = makeElements<T>(sample);
+        DidYouKnow::CreateContainer<V, T> created;
+
+        for (const T &element : elements)
+        {
+            created.addValue(element);
+        }
+
+        const V<T, std::allocator<T>> copied = created.get();
+        bytes = static_cast<double>(liveBytes) / sample;
+    }
+
+    countingBytes = false;
+    return bytes;
+}
+
+template <template <class, class> class V, class T>
+void measure(DidYouKnow::BenchmarkTable &table, const char *container, const char *type,
+             const size_t size, const size_t maximumBytes)
+{
+    if (size * bytesPerElement<V, T>(size) > maximumBytes)
+    {
+        return;
+    }
+
+    const std::vector<T> elements = makeElements<T>(size);
+
+    const size_t repetitions = std::max<size_t>(3, 100000 / size);
+    double build = 0, iterate = 0, copyOut = 0, destroy = 0;
+
+    for (size_t repetition = 0; repetition < repetitions; ++repetition)
+    {
+        DidYouKnow::Stopwatch::time_point started = DidYouKnow::Stopwatch::now();
+        ExposesContainer<V, T> *created = new ExposesContainer<V, T>();
+
+        for (const T &element : elements)
+        {
+            created->addValue(element);
+        }
+
+        build += DidYouKnow::nanosecondsSince(started);
+        started = DidYouKnow::Stopwatch::now();
+        size_t weight = 0;
+
+        for (const T &element : created->_container)
+        {
+            weight += weigh(element);
+        }
+
+        DidYouKnow::doNotOptimise(weight);
+        iterate += DidYouKnow::nanosecondsSince(started);
+        started = DidYouKnow::Stopwatch::now();
+        V<T, std::allocator<T>> *copied = new V<T, std::allocator<T>>(created->get());
+        DidYouKnow::doNotOptimise(copied);
+        copyOut += DidYouKnow::nanosecondsSince(started);
+
+        started = DidYouKnow::Stopwatch::now();
+        delete copied;
+        delete created;
+        destroy += DidYouKnow::nanosecondsSince(started);
+    }
+
+    const double measured = static_cast<double>(repetitions * size);
+    table.add({container, type, std::to_string(size)},
+              {build / measured, iterate / measured, copyOut / measured, destroy / measured});
+}
+
+template <typename T>
+void measureContainers(DidYouKnow::BenchmarkTable &table, const char *type, const size_t size, const size_t maximumBytes)
+{
+    measure<std::vector, T>(table, "vector", type, size, maximumBytes);
+    measure<std::deque, T>(table, "deque", type, size, maximumBytes);
+    measure<std::list, T>(table, "list", type, size, maximumBytes);
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t maximumSize = std::stoul(DidYouKnow::benchmarkOption(argc, argv, "--max-size", "10000000"));
+    const size_t maximumBytes = std::stoul(DidYouKnow::benchmarkOption(argc, argv, "--max-bytes", "1000000000"));
+
+    DidYouKnow::BenchmarkTable table({"container", "type", "size"},
+                                     {"build ns/el", "iterate ns/el", "copy ns/el", "destroy ns/el"});
+
+    for (size_t size = 1; size <= maximumSize; size *= 10)
+    {
+        measureContainers<int>(table, "int", size, maximumBytes);
+        measureContainers<std::string>(table, "string", size, maximumBytes);
+        measureContainers<LargeStruct>(table, "LargeStruct", size, maximumBytes);
+    }
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv", "build/Containers.csv");
+    return table.writeCsv(csv) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/Expected.hpp"
+
+/**
+ * Measures what it costs to report a failure from a number of frames down
+ * the stack, by throwing various types, by returning an error code, and by
+ * returning an Expected, on both the failing and the succeeding paths
+ */
+
+struct DerivedError : std::runtime_error
+{
+    DerivedError() : std::runtime_error("derived") {}
+};
+
+template <typename Thrown>
+Thrown makeThrown();
+
+template <>
+int makeThrown<int>()
+{
+    return 1;
+}
+
+template <>
+std::string makeThrown<std::string>()
+{
+    return "an error message too long for the small string optimisation";
+}
+
+template <>
+DerivedError makeThrown<DerivedError>()
+{
+    return DerivedError();
+}
+
+template <typename Thrown>
+__attribute__((noinline)) int throwingAt(const int depth, const bool fail)
+{
+    if (depth == 0)
+    {
+        if (fail)
+        {
+            throw makeThrown<Thrown>();
+        }
+
+        return 1;
+    }
+
+    return throwingAt<Thrown>(depth - 1, fail) + 1;
+}
+
+template <typename Caught>
+int catchThrown(int (*function)(int, bool), const int depth, const bool fail)
+{
+    try
+    {
+        return function(depth, fail);
+    }
+    catch (const Caught &)
+    {
+        return -1;
+    }
+}
+
+__attribute__((noinline)) int errorCodeAt(const int depth, const bool fail, int &result)
+{
+    if (depth == 0)
+    {
+        if (fail)
+        {
+            return 1;
+        }
+
+        result = 1;
+        return 0;
+    }
+
+    if (const int error = errorCodeAt(depth - 1, fail, result))
+    {
+        return error;
+    }
+
+    ++result;
+    return 0;
+}
+
+__attribute__((noinline)) DidYouKnow::Expected<int, int> expectedAt(const int depth, const bool fail)
+{
+    if (depth == 0)
+    {
+        if (fail)
+        {
+            return DidYouKnow::unexpected(1);
+        }
+
+        return 1;
+    }
+
+    return expectedAt(depth - 1, fail).transform([](const int value)
+                                                 { return value + 1; });
+}
+
+int main(int argc, char *argv[])
+{
+    DidYouKnow::BenchmarkTable table({"path", "mechanism", "depth"});
+    const int depths[] = {0, 4, 16, 64};
+
+    for (const bool fail : {true, false})
+    {
+        const std::string path = fail ? "failure" : "success";
+        const size_t throwingIterations = fail ? 20000 : 100000;
+
+        for (const int depth : depths)
+        {
+            const std::string frames = std::to_string(depth);
+
+            table.measure({path, "throw int", frames}, throwingIterations, [&]()
+                          { DidYouKnow::doNotOptimise(catchThrown<int>(&throwingAt<int>, depth, fail)); });
+
+            table.measure({path, "throw string", frames}, throwingIterations, [&]()
+                          { DidYouKnow::doNotOptimise(catchThrown<std::string>(&throwingAt<std::string>, depth, fail)); });
+
+            table.measure({path, "throw derived", frames}, throwingIterations, [&]()
+                          { DidYouKnow::doNotOptimise(catchThrown<std::exception>(&throwingAt<DerivedError>, depth, fail)); });
+
+            table.measure({path, "error code", frames}, 100000, [&]()
+                          {
+                              int result = 0;
+                              DidYouKnow::doNotOptimise(errorCodeAt(depth, fail, result));
+                              DidYouKnow::doNotOptimise(result); });
+
+            table.measure({path, "Expected", frames}, 100000, [&]()
+                          { DidYouKnow::doNotOptimise(expectedAt(depth, fail).valueOr(-1)); });
+        }
+    }
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include <fstream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/MappedTable.hpp"
+
+/**
+ * Measures what it costs a process to load a lookup table of strings on
+ * starting, and to look keys up in it after, from 1000 to a million
+ * entries, comparing parsing "key=value" lines into a std::map with
+ * mapping a MappedTable image of the same table
+ */
+
+std::string keyFor(const size_t i)
+{
+    return "setting." + std::to_string(i * 7919 % 1000003);
+}
+
+std::map<std::string, std::string> readText(const std::string &path)
+{
+    std::map<std::string, std::string> map;
+    std::ifstream file(path.c_str());
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        const size_t equals = line.find('=');
+        map.emplace(line.substr(0, equals), line.substr(equals + 1));
+    }
+
+    return map;
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string base = "build/MappedTable." + std::to_string(getpid());
+    const std::string textPath = base + ".txt", imagePath = base + ".table";
+    DidYouKnow::BenchmarkTable table({"entries", "loaded by"}, {"startup us", "lookup ns"});
+    table.setRepetitions(3);
+
+    for (const size_t entries : {1000, 100000, 1000000})
+    {
+        std::map<std::string, std::string> map;
+        std::vector<std::string> keys;
+
+        for (size_t i = 0; i < entries; ++i)
+        {
+            keys.push_back(keyFor(i));
+            map[keys.back()] = "value for " + keys.back();
+        }
+
+        {
+            std::ofstream text(textPath.c_str());
+
+            for (const auto &entry : map)
+            {
+                text << entry.first << '=' << entry.second << '\n';
+            }
+        }
+
+        DidYouKnow::writeMappedTable(imagePath, map);
+        size_t next = 0;
+
+        const double parsing = table.time(1, [&]()
+                                          { DidYouKnow::doNotOptimise(readText(textPath).size()); });
+        const std::map<std::string, std::string> parsed = readText(textPath);
+        const double mapLookup = table.time(100000, [&]()
+                                            {
+            next = (next + 7) % keys.size();
+            DidYouKnow::doNotOptimise(parsed.find(keys[next])->second.size()); });
+        table.add({std::to_string(entries), "parsing text"}, {parsing / 1e3, mapLookup});
+
+        const double mapping = table.time(1, [&]()
+                                          { DidYouKnow::doNotOptimise(DidYouKnow::MappedTable(imagePath).size()); });
+        const DidYouKnow::MappedTable mapped(imagePath);
+        const double mappedLookup = table.time(100000, [&]()
+                                               {
+            next = (next + 7) % keys.size();
+            DidYouKnow::doNotOptimise(mapped.find(keys[next])->size()); });
+        table.add({std::to_string(entries), "mmap"}, {mapping / 1e3, mappedLookup});
+    }
+
+    std::remove(textPath.c_str());
+    std::remove(imagePath.c_str());
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+#include <charconv>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/Numbers.hpp"
+
+/**
+ * Measures how many millions of numbers a second can be parsed from text
+ * and formatted back into it, through a std::stringstream, an
+ * istream_iterator, plain std::from_chars and std::to_chars, and the
+ * buffer-at-a-time parsing and formatting of Numbers.hpp
+ */
+
+const size_t NumberOfValues = 200000;
+
+/**
+ * Integers of every width, as an ingested file would hold them, one per line
+ */
+std::vector<int> makeIntegers()
+{
+    std::mt19937 random(42);
+    std::vector<int> integers;
+
+    for (size_t i = 0; i < NumberOfValues; ++i)
+    {
+        const int digits = 1 + static_cast<int>(random() % 9);
+        int integer = static_cast<int>(random() % 1000000000);
+
+        for (int j = digits; j < 9; ++j)
+        {
+            integer /= 10;
+        }
+
+        integers.push_back(random() % 4 ? integer : -integer);
+    }
+
+    return integers;
+}
+
+int main(int argc, char *argv[])
+{
+    const std::vector<int> integers = makeIntegers();
+    std::string lines, csv;
+
+    for (size_t i = 0; i < integers.size(); ++i)
+    {
+        DidYouKnow::appendNumber(lines, integers[i]);
+        lines += '\n';
+
+        DidYouKnow::appendNumber(csv, integers[i]);
+        csv += ',';
+        DidYouKnow::appendNumber(csv, integers[i] / 1024.0);
+        csv += '\n';
+    }
+
+    DidYouKnow::BenchmarkTable table({"operation", "method"}, {"Mvalues/s"});
+
+    const auto add = [&](const std::string &operation, const std::string &method, const size_t values, auto body)
+    {
+        table.add({operation, method}, {values / table.time(1, body) * 1e3});
+    };
+
+    add("parse int", "stringstream >>", integers.size(), [&]()
+        {
+        std::istringstream stream(lines);
+        std::vector<int> parsed;
+        int integer;
+
+        while (stream >> integer)
+        {
+            parsed.push_back(integer);
+        }
+
+        DidYouKnow::doNotOptimise(parsed); });
+
+    add("parse int", "istream_iterator", integers.size(), [&]()
+        {
+        std::istringstream stream(lines);
+        const std::vector<int> parsed((std::istream_iterator<int>(stream)), std::istream_iterator<int>());
+        DidYouKnow::doNotOptimise(parsed); });
+
+    add("parse int", "from_chars", integers.size(), [&]()
+        {
+        std::vector<int> parsed;
+        const char *position = lines.data();
+        const char *const last = position + lines.size();
+
+        while (position != last)
+        {
+            int integer;
+            position = std::from_chars(position, last, integer).ptr + 1;
+            parsed.push_back(integer);
+        }
+
+        DidYouKnow::doNotOptimise(parsed); });
+
+    add("parse int", "parseIntegers", integers.size(), [&]()
+        {
+        std::vector<int> parsed;
+        DidYouKnow::parseIntegers(lines, parsed);
+        DidYouKnow::doNotOptimise(parsed); });
+
+    add("parse csv", "stringstream >>", 2 * integers.size(), [&]()
+        {
+        std::istringstream stream(csv);
+        std::vector<long long> integerColumn;
+        std::vector<double> realColumn;
+        long long integer;
+        double real;
+        char comma;
+
+        while (stream >> integer >> comma >> real)
+        {
+            integerColumn.push_back(integer);
+            realColumn.push_back(real);
+        }
+
+        DidYouKnow::doNotOptimise(realColumn); });
+
+    add("parse csv", "Columns", 2 * integers.size(), [&]()
+        {
+        DidYouKnow::Columns columns({DidYouKnow::ColumnType::Integer, DidYouKnow::ColumnType::Real});
+        columns.parse(csv);
+        DidYouKnow::doNotOptimise(columns); });
+
+    add("format int", "stringstream endl", integers.size(), [&]()
+        {
+        std::ostringstream stream;
+
+        for (const int integer : integers)
+        {
+            stream << integer << std::endl;
+        }
+
+        DidYouKnow::doNotOptimise(stream.str()); });
+
+    add("format int", "stringstream \\n", integers.size(), [&]()
+        {
+        std::ostringstream stream;
+
+        for (const int integer : integers)
+        {
+            stream << integer << '\n';
+        }
+
+        DidYouKnow::doNotOptimise(stream.str()); });
+
+    add("format int", "appendNumber", integers.size(), [&]()
+        {
+        std::string formatted;
+
+        for (const int integer : integers)
+        {
+            DidYouKnow::appendNumber(formatted, integer);
+            formatted += '\n';
+        }
+
+        DidYouKnow::doNotOptimise(formatted); });
+
+    DidYouKnow::Columns columns({DidYouKnow::ColumnType::Integer, DidYouKnow::ColumnType::Real});
+    columns.parse(csv);
+
+    add("format csv", "stringstream \\n", 2 * integers.size(), [&]()
+        {
+        std::ostringstream stream;
+        stream.precision(17);
+
+        for (size_t i = 0; i < columns.rows(); ++i)
+        {
+            stream << columns.integers(0)[i] << ',' << columns.reals(1)[i] << '\n';
+        }
+
+        DidYouKnow::doNotOptimise(stream.str()); });
+
+    add("format csv", "Columns", 2 * integers.size(), [&]()
+        {
+        std::string formatted;
+        columns.format(formatted);
+        DidYouKnow::doNotOptimise(formatted); });
+
+    const std::string csvPath = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csvPath.empty() || table.writeCsv(csvPath) ? 0 : 1;
+}
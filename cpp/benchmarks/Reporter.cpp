@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/Reporter.hpp"
+
+/**
+ * Measures what reporting results costs the threads running tests, from 1
+ * to 16 of them, as the number of results grows, comparing the Reporter
+ * with a std::ofstream guarded by a std::mutex, flushed for each result
+ * with std::endl, as the runner's output used to be
+ */
+
+const char *const TestName = "testReportedFromAWorker";
+
+class LockedStream
+{
+    std::mutex _mutex;
+    std::ofstream _file;
+
+  public:
+    explicit LockedStream(const std::string &path) : _file(path.c_str()) {}
+
+    void report(const DidYouKnow::ReportRecord &record)
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _file << "{\"name\":\"" << record.name << "\",\"outcome\":\"passed\",\"nanoseconds\":" << record.nanoseconds
+              << ",\"samples\":" << record.samples << ",\"instructions\":" << record.instructions << '}' << std::endl;
+    }
+
+    void close()
+    {
+        _file.close();
+    }
+};
+
+/**
+ * Returns the nanoseconds per result spent by the workers reporting, and
+ * the nanoseconds per result until every result has been written
+ */
+template <typename Sink>
+std::pair<double, double> costPerResult(Sink &sink, const int workers, const int results)
+{
+    std::vector<std::thread> threads;
+    const DidYouKnow::Stopwatch::time_point started = DidYouKnow::Stopwatch::now();
+
+    for (int worker = 0; worker < workers; ++worker)
+    {
+        threads.push_back(std::thread([&, worker]()
+                                      {
+            for (int i = worker; i < results; i += workers)
+            {
+                sink.report(DidYouKnow::ReportRecord{TestName, DidYouKnow::Outcome::Passed, 1000.0 + i, 1, i});
+            } }));
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    const double reporting = DidYouKnow::nanosecondsSince(started);
+    sink.close();
+    return std::make_pair(reporting / results, DidYouKnow::nanosecondsSince(started) / results);
+}
+
+int main(int argc, char *argv[])
+{
+    const std::string path = "build/Reporter." + std::to_string(getpid()) + ".jsonl";
+    DidYouKnow::BenchmarkTable table({"reporter", "workers", "results"}, {"ns/result", "written ns/result"});
+
+    for (const int results : {1000, 100000})
+    {
+        for (const int workers : {1, 2, 4, 8, 16})
+        {
+            LockedStream locked(path);
+            const std::pair<double, double> lockedCost = costPerResult(locked, workers, results);
+            table.add({"mutex+endl", std::to_string(workers), std::to_string(results)}, {lockedCost.first, lockedCost.second});
+
+            DidYouKnow::Reporter reporter(path, "");
+            const std::pair<double, double> reporterCost = costPerResult(reporter, workers, results);
+            table.add({"Reporter", std::to_string(workers), std::to_string(results)}, {reporterCost.first, reporterCost.second});
+        }
+    }
+
+    std::remove(path.c_str());
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
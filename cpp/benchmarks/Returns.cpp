@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+
+/**
+ * Measures the ways a function can hand back a value, as weighed up by
+ * testScopeGuardTrick, for a string short enough for the small string
+ * optimisation, one too long for it, and a large container: returning by
+ * value, with and without the named return value optimisation, moving on
+ * return, binding the result to a const reference, filling an
+ * out-parameter, fresh or reused, and writing through an output iterator.
+ * Every allocation is counted by replacing the global operator new, and
+ * every copy and move of the returned object by wrapping it in Counted.
+ */
+
+struct Counts
+{
+    size_t allocations = 0;
+    size_t copies = 0;
+    size_t moves = 0;
+};
+
+Counts counts;
+
+void *operator new(const size_t size)
+{
+    ++counts.allocations;
+
+    if (void *allocated = std::malloc(size ? size : 1))
+    {
+        return allocated;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *allocated) noexcept
+{
+    std::free(allocated);
+}
+
+void operator delete(void *allocated, size_t) noexcept
+{
+    std::free(allocated);
+}
+
+/**
+ * A value that counts how often it is copied and moved
+ */
+template <typename T>
+struct Counted
+{
+    T value;
+
+    Counted() = default;
+
+    Counted(const Counted &other) : value(other.value)
+    {
+        ++counts.copies;
+    }
+
+    Counted(Counted &&other) noexcept : value(std::move(other.value))
+    {
+        ++counts.moves;
+    }
+
+    Counted &operator=(const Counted &other)
+    {
+        value = other.value;
+        ++counts.copies;
+        return *this;
+    }
+
+    Counted &operator=(Counted &&other) noexcept
+    {
+        value = std::move(other.value);
+        ++counts.moves;
+        return *this;
+    }
+};
+
+/**
+ * A payload of a given size, and what it is made of
+ */
+template <typename T>
+struct Payload
+{
+    const char *name;
+    size_t size;
+    typename T::value_type element;
+};
+
+template <typename T>
+__attribute__((noinline)) void fill(T &value, const Payload<T> &payload)
+{
+    value.assign(payload.size, payload.element);
+}
+
+template <typename T>
+__attribute__((noinline)) Counted<T> returnNamed(const Payload<T> &payload)
+{
+    Counted<T> result;
+    fill(result.value, payload);
+    return result;
+}
+
+template <typename T>
+__attribute__((noinline)) Counted<T> returnMoved(const Payload<T> &payload)
+{
+    Counted<T> result;
+    fill(result.value, payload);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpessimizing-move"
+    return std::move(result);
+#pragma GCC diagnostic pop
+}
+
+/**
+ * Either of two named values may be returned, so neither can be built in
+ * the caller's storage, and the one returned is moved out
+ */
+template <typename T>
+__attribute__((noinline)) Counted<T> returnEitherNamed(const Payload<T> &payload, const bool first)
+{
+    Counted<T> one, other;
+    fill(first ? one.value : other.value, payload);
+
+    if (first)
+    {
+        return one;
+    }
+
+    return other;
+}
+
+/**
+ * The conditional operator makes a copy of whichever it picks
+ */
+template <typename T>
+__attribute__((noinline)) Counted<T> returnConditional(const Payload<T> &payload, const bool first)
+{
+    Counted<T> one, other;
+    fill(first ? one.value : other.value, payload);
+    return first ? one : other;
+}
+
+template <typename T>
+__attribute__((noinline)) void fillOut(Counted<T> &out, const Payload<T> &payload)
+{
+    fill(out.value, payload);
+}
+
+template <typename T, typename Output>
+__attribute__((noinline)) void writeTo(Output out, const Payload<T> &payload)
+{
+    std::fill_n(out, payload.size, payload.element);
+}
+
+template <typename T>
+void measure(DidYouKnow::BenchmarkTable &table, const Payload<T> &payload)
+{
+    const size_t iterations = payload.size > 100 ? 2000 : 200000;
+    bool first = true;
+    Counted<T> reused;
+
+    const auto add = [&](const char *strategy, auto body)
+    {
+        const Counts before = counts;
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            body();
+        }
+
+        const double allocations = static_cast<double>(counts.allocations - before.allocations) / iterations;
+        const double copies = static_cast<double>(counts.copies - before.copies) / iterations;
+        const double moves = static_cast<double>(counts.moves - before.moves) / iterations;
+        table.add({payload.name, strategy}, {table.time(iterations, body), allocations, copies, moves});
+    };
+
+    add("return by value", [&]()
+        {
+        const Counted<T> result = returnNamed(payload);
+        DidYouKnow::doNotOptimise(result.value.size()); });
+
+    add("const reference", [&]()
+        {
+        const Counted<T> &kept = returnNamed(payload);
+        DidYouKnow::doNotOptimise(kept.value.size()); });
+
+    add("std::move return", [&]()
+        {
+        const Counted<T> result = returnMoved(payload);
+        DidYouKnow::doNotOptimise(result.value.size()); });
+
+    add("either of two", [&]()
+        {
+        first = !first;
+        const Counted<T> result = returnEitherNamed(payload, first);
+        DidYouKnow::doNotOptimise(result.value.size()); });
+
+    add("conditional ?:", [&]()
+        {
+        first = !first;
+        const Counted<T> result = returnConditional(payload, first);
+        DidYouKnow::doNotOptimise(result.value.size()); });
+
+    add("assign to existing", [&]()
+        {
+        reused = returnNamed(payload);
+        DidYouKnow::doNotOptimise(reused.value.size()); });
+
+    add("out-parameter", [&]()
+        {
+        Counted<T> out;
+        fillOut(out, payload);
+        DidYouKnow::doNotOptimise(out.value.size()); });
+
+    add("reused out-param", [&]()
+        {
+        fillOut(reused, payload);
+        DidYouKnow::doNotOptimise(reused.value.size()); });
+
+    add("output iterator", [&]()
+        {
+        Counted<T> out;
+        writeTo<T>(std::back_inserter(out.value), payload);
+        DidYouKnow::doNotOptimise(out.value.size()); });
+}
+
+int main(int argc, char *argv[])
+{
+    DidYouKnow::BenchmarkTable table({"payload", "strategy"}, {"ns/call", "allocs/call", "copies/call", "moves/call"});
+
+    measure(table, Payload<std::string>{"string 8", 8, 'x'});
+    measure(table, Payload<std::string>{"string 64", 64, 'x'});
+    measure(table, Payload<std::vector<std::string>>{"vector 10000", 10000, std::string(32, 'x')});
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
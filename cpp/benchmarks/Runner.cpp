@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/CreateContainer.hpp"
+#include "DidYouKnow/Runner.hpp"
+
+/**
+ * Measures how the runner itself scales, on synthetic suites of up to a
+ * million tests of each cost profile: how long registering them through
+ * CreateContainer takes, and the bytes it allocates, what the runner adds
+ * to each test beyond the test itself, and allocates for it, and how much
+ * of the ideal speed-up a pool of threads realises over a pool of one,
+ * running the same path.  Suites are run both bare, in registered order
+ * with no history, journal or timeout, and as a plain main.exe run does,
+ * scheduled from the records of an earlier run, journalled and watched,
+ * one at a time and on the pool; the overhead is that of the default.
+ * The first row runs no tests at all, timing the runner's startup.  Sleeping tests
+ * are only run up to ten thousand at a time, as a million would take
+ * minutes.  Allocations are counted by replacing the global operator new,
+ * rather than from the resident set, which the allocator's reuse of freed
+ * memory makes too coarse to compare.  Efficiency needs as many cores as
+ * threads, and is meaningless on fewer.
+ */
+
+std::atomic<size_t> allocatedBytes{0};
+
+// Kept out of line, so GCC does not see free() called on what operator new returned, and warn
+__attribute__((noinline)) void *allocate(const size_t size)
+{
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void *allocated = std::malloc(size ? size : 1))
+    {
+        return allocated;
+    }
+
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void release(void *allocated) noexcept
+{
+    std::free(allocated);
+}
+
+void *operator new(const size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](const size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *allocated) noexcept
+{
+    release(allocated);
+}
+
+void operator delete[](void *allocated) noexcept
+{
+    release(allocated);
+}
+
+void operator delete(void *allocated, size_t) noexcept
+{
+    release(allocated);
+}
+
+void operator delete[](void *allocated, size_t) noexcept
+{
+    release(allocated);
+}
+
+enum class Profile
+{
+    Empty,
+    Cpu,
+    Allocating,
+    Sleeping
+};
+
+const char *describe(const Profile profile)
+{
+    return profile == Profile::Empty ? "empty" : profile == Profile::Cpu ? "cpu"
+                                             : profile == Profile::Allocating ? "allocating"
+                                                                              : "sleeping";
+}
+
+void runBody(const Profile profile)
+{
+    if (profile == Profile::Cpu)
+    {
+        unsigned value = 1;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            value = value * 2654435761u + 1;
+        }
+
+        DidYouKnow::doNotOptimise(value);
+    }
+    else if (profile == Profile::Allocating)
+    {
+        std::vector<std::string> strings(16, std::string(40, 'x'));
+        DidYouKnow::doNotOptimise(strings);
+    }
+    else if (profile == Profile::Sleeping)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+/**
+ * Runs a suite through the runner, as main.exe would be run, either bare
+ * or with its defaults, keeping history in the given directory, returning
+ * the nanoseconds taken, with its output discarded
+ */
+double runSuite(const std::vector<DidYouKnow::Test> &tests, const size_t threads, const bool defaults = false,
+                const std::string &directory = std::string())
+{
+    const std::string threadCount = std::to_string(threads);
+    const std::string history = directory + "/history.log", schedule = directory + "/schedule.log";
+    const char *bare[] = {"Runner.exe", "--no-history", "--registered-order", "--timeout", "0", "--threads", threadCount.c_str()};
+    const char *recorded[] = {"Runner.exe", "--history", history.c_str(), "--schedule", schedule.c_str(), "--threads", threadCount.c_str()};
+    const char **arguments = defaults ? recorded : bare;
+    std::ostringstream discarded;
+    std::streambuf *const output = std::cout.rdbuf(discarded.rdbuf());
+
+    const DidYouKnow::Stopwatch::time_point started = DidYouKnow::Stopwatch::now();
+    const int status = DidYouKnow::run(tests, {}, sizeof(bare) / sizeof(bare[0]), const_cast<char **>(arguments));
+    const double nanoseconds = DidYouKnow::nanosecondsSince(started);
+
+    std::cout.rdbuf(output);
+
+    if (status != 0)
+    {
+        std::cerr << "The synthetic suite failed" << std::endl;
+    }
+
+    return nanoseconds;
+}
+
+/**
+ * Runs a suite on the runner's pool of threads alone, returning the
+ * nanoseconds taken, so pools of different sizes are compared over the
+ * same path, rather than against the serial one, which guards and counts
+ * each test as the pool does not
+ */
+double runPool(const std::vector<DidYouKnow::Test> &tests, const size_t threads)
+{
+    std::vector<DidYouKnow::TestResult> results;
+    std::vector<size_t> indexes;
+    results.reserve(tests.size());
+
+    for (size_t i = 0; i < tests.size(); ++i)
+    {
+        results.push_back(DidYouKnow::TestResult(tests[i].name));
+        indexes.push_back(i);
+    }
+
+    const DidYouKnow::Watchdog watchdog(std::chrono::milliseconds(0), std::chrono::milliseconds(0));
+    const DidYouKnow::Progress progress("", 1);
+    const DidYouKnow::Stopwatch::time_point started = DidYouKnow::Stopwatch::now();
+    DidYouKnow::runThreaded(tests, indexes, threads, results, watchdog, progress);
+    return DidYouKnow::nanosecondsSince(started);
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t maximum = std::stoul(DidYouKnow::benchmarkOption(argc, argv, "--max-tests", "1000000"));
+    const size_t threads = std::stoul(DidYouKnow::benchmarkOption(argc, argv, "--threads", "4"));
+    DidYouKnow::BenchmarkTable table({"profile", "tests"}, {"register ns", "register B", "body ns", "bare ns", "default ns", "threaded ns", "run B", "overhead ns", "efficiency %"});
+    std::string directory = (std::filesystem::temp_directory_path() / "RunnerBenchmark.XXXXXX").string();
+
+    if (!mkdtemp(directory.data()))
+    {
+        std::cerr << "Could not make a directory for the runner's history" << std::endl;
+        return 1;
+    }
+
+    table.add({"none", "0"}, {0, 0, 0, runSuite({}, 1), runSuite({}, 1, true, directory), 0, 0, 0, 0});
+
+    for (const Profile profile : {Profile::Empty, Profile::Cpu, Profile::Allocating, Profile::Sleeping})
+    {
+        for (size_t size = 1000; size <= (profile == Profile::Sleeping ? std::min<size_t>(maximum, 10000) : maximum); size *= 10)
+        {
+            std::vector<std::string> names;
+            names.reserve(size);
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                names.push_back(std::string(describe(profile)) + std::to_string(i));
+            }
+
+            // Per test, as main() registers them, including the copy get() makes
+            const size_t registerBefore = allocatedBytes;
+            const DidYouKnow::Stopwatch::time_point registering = DidYouKnow::Stopwatch::now();
+            DidYouKnow::CreateContainer<std::vector, DidYouKnow::Test> container;
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                container(DidYouKnow::Test(names[i].c_str(), [profile]()
+                                           { runBody(profile); })
+                              .markedThreadSafe());
+            }
+
+            const std::vector<DidYouKnow::Test> tests = container.get();
+            const double registered = DidYouKnow::nanosecondsSince(registering) / size;
+            const double registeredBytes = static_cast<double>(allocatedBytes - registerBefore) / size;
+
+            const DidYouKnow::Stopwatch::time_point bodies = DidYouKnow::Stopwatch::now();
+
+            for (size_t i = 0; i < size; ++i)
+            {
+                runBody(profile);
+            }
+
+            const double body = DidYouKnow::nanosecondsSince(bodies) / size;
+            const size_t runBefore = allocatedBytes;
+            const double serial = runSuite(tests, 1) / size;
+            const double runBytes = static_cast<double>(allocatedBytes - runBefore) / size;
+
+            // The first default run leaves the records the second is scheduled from, as most runs are
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directory(directory);
+            runSuite(tests, 1, true, directory);
+            const double scheduled = runSuite(tests, 1, true, directory) / size;
+            const double threadedDefault = runSuite(tests, threads, true, directory) / size;
+            double pooled = runPool(tests, 1), threaded = runPool(tests, threads);
+
+            // The best of three each, taken in turn, as one run of each is at the mercy of the other's leftovers
+            for (int repeat = 0; repeat < 2; ++repeat)
+            {
+                pooled = std::min(pooled, runPool(tests, 1));
+                threaded = std::min(threaded, runPool(tests, threads));
+            }
+
+            table.add({describe(profile), std::to_string(size)},
+                      {registered, registeredBytes, body, serial, scheduled, threadedDefault, runBytes, scheduled - body,
+                       100 * pooled / (threads * threaded)});
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/SmallFunction.hpp"
+
+/**
+ * Measures what each case of a parameterised test costs, as forEachCase
+ * and forEachGenerated call a generator and a body per case: through a
+ * lambda the compiler can see into, a plain function pointer, a
+ * std::function and a SmallFunction, in nanoseconds per case.  What it
+ * costs to make and copy each, as a test is when registered, is measured
+ * too, for captures small enough for std::function to keep inline and
+ * ones too large for it, with every allocation counted by replacing the
+ * global operator new.
+ */
+
+const size_t NumberOfCases = 1000000;
+
+size_t allocations = 0;
+
+// Kept out of line, so GCC does not see free() called on what operator new returned, and warn
+__attribute__((noinline)) void *allocate(const size_t size)
+{
+    ++allocations;
+
+    if (void *allocated = std::malloc(size ? size : 1))
+    {
+        return allocated;
+    }
+
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void release(void *allocated) noexcept
+{
+    std::free(allocated);
+}
+
+void *operator new(const size_t size)
+{
+    return allocate(size);
+}
+
+void *operator new[](const size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void *allocated) noexcept
+{
+    release(allocated);
+}
+
+void operator delete[](void *allocated) noexcept
+{
+    release(allocated);
+}
+
+void operator delete(void *allocated, size_t) noexcept
+{
+    release(allocated);
+}
+
+void operator delete[](void *allocated, size_t) noexcept
+{
+    release(allocated);
+}
+
+// What a function pointer must reach through a global, as it captures nothing
+unsigned seed = 2654435761u;
+unsigned total = 0;
+
+unsigned generateCase(const size_t i)
+{
+    return static_cast<unsigned>(i) * seed;
+}
+
+void checkCase(const unsigned value)
+{
+    total += value >> 7;
+}
+
+/**
+ * Runs every case as forEachGenerated does, kept out of line so each kind
+ * of callable is called through whatever it really is
+ */
+template <typename Generate, typename Body>
+__attribute__((noinline)) void runCases(const Generate &generate, const Body &body)
+{
+    for (size_t i = 0; i < NumberOfCases; ++i)
+    {
+        body(generate(i));
+    }
+}
+
+/**
+ * Captures of a given size, as a test body holding some of its state might
+ */
+template <size_t Size>
+struct Captures
+{
+    unsigned values[Size / sizeof(unsigned)];
+};
+
+int main(int argc, char *argv[])
+{
+    DidYouKnow::BenchmarkTable table({"callable", "operation", "captures"}, {"ns", "allocations"});
+    unsigned captured = 0;
+
+    const auto generate = [](const size_t i)
+    {
+        return static_cast<unsigned>(i) * seed;
+    };
+
+    const auto body = [&captured](const unsigned value)
+    {
+        captured += value >> 7;
+    };
+
+    const auto call = [&](const std::string &callable, auto run)
+    {
+        table.add({callable, "call per case", "-"}, {table.time(1, run) / NumberOfCases, 0});
+    };
+
+    call("lambda", [&]()
+         {
+        runCases(generate, body);
+        DidYouKnow::doNotOptimise(captured); });
+
+    call("function pointer", [&]()
+         {
+        runCases(&generateCase, &checkCase);
+        DidYouKnow::doNotOptimise(total); });
+
+    const std::function<unsigned(size_t)> generateFunction = generate;
+    const std::function<void(unsigned)> bodyFunction = body;
+
+    call("std::function", [&]()
+         {
+        runCases(generateFunction, bodyFunction);
+        DidYouKnow::doNotOptimise(captured); });
+
+    const DidYouKnow::SmallFunction<unsigned(size_t)> generateSmall = generate;
+    const DidYouKnow::SmallFunction<void(unsigned)> bodySmall = body;
+
+    call("SmallFunction", [&]()
+         {
+        runCases(generateSmall, bodySmall);
+        DidYouKnow::doNotOptimise(captured); });
+
+    const auto makeAndCopy = [&](const std::string &callable, const std::string &captures, auto make)
+    {
+        const size_t before = allocations;
+        make();
+        const size_t made = allocations - before;
+        table.add({callable, "make and copy", captures}, {table.time(1000, make), static_cast<double>(made)});
+    };
+
+    makeAndCopy("function pointer", "none", []()
+                {
+        void (*made)(unsigned) = &checkCase;
+        DidYouKnow::doNotOptimise(made);
+        void (*const copied)(unsigned) = made;
+        DidYouKnow::doNotOptimise(copied); });
+
+    const Captures<16> small = {};
+    const Captures<24> large = {};
+
+    makeAndCopy("std::function", "16 bytes", [&small]()
+                {
+        const std::function<void()> made = [small]()
+        { DidYouKnow::doNotOptimise(small); };
+        const std::function<void()> copied = made;
+        DidYouKnow::doNotOptimise(copied); });
+
+    makeAndCopy("std::function", "24 bytes", [&large]()
+                {
+        const std::function<void()> made = [large]()
+        { DidYouKnow::doNotOptimise(large); };
+        const std::function<void()> copied = made;
+        DidYouKnow::doNotOptimise(copied); });
+
+    makeAndCopy("SmallFunction", "16 bytes", [&small]()
+                {
+        const DidYouKnow::SmallFunction<void()> made = [small]()
+        { DidYouKnow::doNotOptimise(small); };
+        const DidYouKnow::SmallFunction<void()> copied = made;
+        DidYouKnow::doNotOptimise(copied); });
+
+    makeAndCopy("SmallFunction", "24 bytes", [&large]()
+                {
+        const DidYouKnow::SmallFunction<void()> made = [large]()
+        { DidYouKnow::doNotOptimise(large); };
+        const DidYouKnow::SmallFunction<void()> copied = made;
+        DidYouKnow::doNotOptimise(copied); });
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/SnapshotMap.hpp"
+
+/**
+ * Measures the throughput of configuration lookups from 1 to 64 reading
+ * threads, while another thread keeps publishing updates, comparing the
+ * lock-free SnapshotMap with a std::map guarded by a std::shared_mutex
+ */
+
+typedef std::map<std::string, std::string> Configuration;
+
+const int NumberOfKeys = 1000;
+
+std::string keyFor(const int i)
+{
+    return "setting." + std::to_string(i);
+}
+
+Configuration makeConfiguration()
+{
+    Configuration configuration;
+
+    for (int i = 0; i < NumberOfKeys; ++i)
+    {
+        configuration[keyFor(i)] = "value" + std::to_string(i);
+    }
+
+    return configuration;
+}
+
+class LockedMap
+{
+    mutable std::shared_mutex _mutex;
+    Configuration _map;
+
+  public:
+    explicit LockedMap(const Configuration &initial) : _map(initial) {}
+
+    size_t lookup(const std::string &key) const
+    {
+        const std::shared_lock<std::shared_mutex> lock(_mutex);
+        const Configuration::const_iterator found = _map.find(key);
+        return found == _map.end() ? 0 : found->second.size();
+    }
+
+    void set(const std::string &key, const std::string &value)
+    {
+        const std::unique_lock<std::shared_mutex> lock(_mutex);
+        _map[key] = value;
+    }
+};
+
+class SnapshotConfiguration
+{
+    DidYouKnow::SnapshotMap<std::string, std::string> _map;
+
+  public:
+    explicit SnapshotConfiguration(const Configuration &initial) : _map(initial) {}
+
+    size_t lookup(const std::string &key) const
+    {
+        const DidYouKnow::SnapshotMap<std::string, std::string>::Snapshot snapshot = _map.snapshot();
+        const std::string *found = snapshot.find(key);
+        return found ? found->size() : 0;
+    }
+
+    void set(const std::string &key, const std::string &value)
+    {
+        _map.set(key, value);
+    }
+};
+
+/**
+ * Returns the total lookups per second made by all the readers
+ */
+template <typename Map>
+double lookupsPerSecond(Map &map, const int readers, const std::chrono::milliseconds duration)
+{
+    std::vector<std::string> keys;
+
+    for (int i = 0; i < NumberOfKeys; ++i)
+    {
+        keys.push_back(keyFor(i));
+    }
+
+    std::atomic<bool> running(true);
+    std::atomic<unsigned long long> lookups(0);
+    std::vector<std::thread> threads;
+
+    for (int reader = 0; reader < readers; ++reader)
+    {
+        threads.push_back(std::thread([&, reader]()
+                                      {
+            unsigned long long made = 0;
+            size_t found = 0;
+
+            for (size_t i = reader; running.load(std::memory_order_relaxed); i += 7)
+            {
+                found += map.lookup(keys[i % keys.size()]);
+                ++made;
+            }
+
+            DidYouKnow::doNotOptimise(found);
+            lookups.fetch_add(made); }));
+    }
+
+    std::thread writer([&]()
+                       {
+        for (int update = 0; running.load(); ++update)
+        {
+            map.set(keys[update % keys.size()], "updated" + std::to_string(update));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } });
+
+    const DidYouKnow::Stopwatch::time_point started = DidYouKnow::Stopwatch::now();
+    std::this_thread::sleep_for(duration);
+    running.store(false);
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    writer.join();
+    return lookups.load() / (DidYouKnow::nanosecondsSince(started) / 1e9);
+}
+
+int main(int argc, char *argv[])
+{
+    const std::chrono::milliseconds duration(std::stoi(DidYouKnow::benchmarkOption(argc, argv, "--duration-ms", "200")));
+    const Configuration initial = makeConfiguration();
+    DidYouKnow::BenchmarkTable table({"map", "readers"}, {"Mlookups/s", "per reader"});
+
+    for (const int readers : {1, 2, 4, 8, 16, 32, 64})
+    {
+        LockedMap locked(initial);
+        const double lockedRate = lookupsPerSecond(locked, readers, duration) / 1e6;
+        table.add({"shared_mutex", std::to_string(readers)}, {lockedRate, lockedRate / readers});
+
+        SnapshotConfiguration snapshots(initial);
+        const double snapshotRate = lookupsPerSecond(snapshots, readers, duration) / 1e6;
+        table.add({"SnapshotMap", std::to_string(readers)}, {snapshotRate, snapshotRate / readers});
+    }
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? 0 : 1;
+}
@@ -1,56 +1,79 @@
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <list>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
+#include <sys/socket.h>
+#include <unistd.h>
 #include <vector>
 
+#include "DidYouKnow/AlignedBuffer.hpp"
+#include "DidYouKnow/CreateContainerInstantiations.hpp"
+#include "DidYouKnow/Expected.hpp"
+#include "DidYouKnow/Fixture.hpp"
+#include "DidYouKnow/MappedTable.hpp"
+#include "DidYouKnow/Numbers.hpp"
+#include "DidYouKnow/Parameterised.hpp"
+#include "DidYouKnow/Runner.hpp"
+#include "DidYouKnow/SnapshotMap.hpp"
+
 namespace Assert
 {
 template <typename T>
-static void AreEqual(T expected, T actual)
+static constexpr void AreEqual(T expected, T actual)
 {
     assert(expected == actual);
 }
 
-static void AreEqual(const char *expected, std::string actual)
+static constexpr void AreEqual(const char *expected, std::string actual)
 {
     assert(expected == actual);
 }
 
-static void AreEqual(std::string expected, const char *actual)
+static constexpr void AreEqual(std::string expected, const char *actual)
 {
     assert(expected == actual);
 }
 
-static void AreEqual(unsigned char expected, int actual)
+static constexpr void AreEqual(unsigned char expected, int actual)
 {
     assert(expected == actual);
 }
 
-static void AreEqual(int expected, unsigned char actual)
+static constexpr void AreEqual(int expected, unsigned char actual)
 {
     assert(expected == actual);
 }
 
 template <typename T>
-static void AreNotEqual(T expected, T actual)
+static constexpr void AreNotEqual(T expected, T actual)
 {
     assert(expected != actual);
 }
 
-static void IsFalse(bool comparison)
+static constexpr void IsFalse(bool comparison)
 {
     assert(comparison ? 0 : 1);
 }
 
-static void IsTrue(bool comparison)
+static constexpr void IsTrue(bool comparison)
 {
     assert(comparison ? 1 : 0);
 }
@@ -60,7 +83,7 @@ static void Fail()
     assert(0);
 }
 
-static void Success()
+static constexpr void Success()
 {
     return assert(1);
 }
@@ -113,6 +136,87 @@ void testArrayIndexAccess()
     Assert::AreEqual(64, 2 [array]);
 }
 
+/**
+ * An array tells the vectoriser neither its alignment nor its length.  An
+ * AlignedBuffer promises both, padding itself to whole vectors, so every
+ * instruction set's kernels can run to the end without a scalar tail, and
+ * must agree with the scalar ones, up to the fused multiply-add's rounding
+ */
+void testAlignedBufferKernelsAgreeAtEveryLevel()
+{
+    const size_t size = 37;
+    DidYouKnow::FloatBuffer a(size), b(size), c(size);
+    DidYouKnow::IndexBuffer indexes(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        // Small integers, so that every product and sum is exact
+        a[i] = static_cast<float>(i % 7) - 3;
+        b[i] = static_cast<float>(i % 5);
+        c[i] = static_cast<float>(i);
+        indexes[i] = static_cast<int32_t>(size - 1 - i);
+    }
+
+    Assert::AreEqual(0, static_cast<int>(reinterpret_cast<uintptr_t>(a.data()) % 64));
+    Assert::AreEqual(48, static_cast<int>(a.capacity()));
+    Assert::AreEqual(0.0f, a.data()[a.capacity() - 1]);
+
+    const DidYouKnow::SimdLevel levels[] = {DidYouKnow::SimdLevel::Scalar, DidYouKnow::SimdLevel::Sse, DidYouKnow::SimdLevel::Avx2};
+
+    for (const DidYouKnow::SimdLevel level : levels)
+    {
+        if (level > DidYouKnow::bestSimd())
+        {
+            continue;
+        }
+
+        DidYouKnow::FloatBuffer sum(size), scaled(size), fused(size), gathered(size);
+        DidYouKnow::IndexBuffer greater(size);
+        DidYouKnow::add(a, b, sum, level);
+        DidYouKnow::scale(a, 0.5f, scaled, level);
+        DidYouKnow::multiplyAdd(a, b, c, fused, level);
+        DidYouKnow::greater(a, b, greater, level);
+        DidYouKnow::gather(c, indexes, gathered, level);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            Assert::AreEqual(a[i] + b[i], sum[i]);
+            Assert::AreEqual(a[i] * 0.5f, scaled[i]);
+            Assert::AreEqual(a[i] * b[i] + c[i], fused[i]);
+            Assert::AreEqual(a[i] > b[i] ? 1 : 0, greater[i]);
+            Assert::AreEqual(c[size - 1 - i], gathered[i]);
+        }
+    }
+
+    const DidYouKnow::FloatBuffer huge(1 << 20, 1.0f);
+    Assert::AreEqual(1.0f, huge[(1 << 20) - 1]);
+#ifdef __linux__
+    Assert::IsTrue(huge.mapped());
+#endif
+
+    try
+    {
+        DidYouKnow::add(a, DidYouKnow::FloatBuffer(size + 1), c);
+        Assert::Fail();
+    }
+    catch (const std::invalid_argument &)
+    {
+        Assert::Success();
+    }
+
+#ifndef NDEBUG
+    try
+    {
+        a[size] = 0;
+        Assert::Fail();
+    }
+    catch (const std::out_of_range &)
+    {
+        Assert::Success();
+    }
+#endif
+}
+
 /**
  * Originally implemented for limited keyboards and terminals, why not
  * clarify or obfuscate your codebase with these plain-text alternatives?
@@ -144,7 +248,7 @@ void testKeywordOperatorTokens()
 class ContainsHidden
 {
   public:
-    ContainsHidden(const int member) : _member(member) {}
+    constexpr ContainsHidden(const int member) : _member(member) {}
 
   protected:
     const int _member;
@@ -153,14 +257,14 @@ class ContainsHidden
 class PromotesHidden : public ContainsHidden
 {
   public:
-    PromotesHidden(int member) : ContainsHidden(member) {}
+    constexpr PromotesHidden(int member) : ContainsHidden(member) {}
     using ContainsHidden::_member;
 };
 
 /**
  * Demonstrates how to alter the scope of class members in their derived classes
  */
-void testChangingScope()
+constexpr void testChangingScope()
 {
     Assert::AreEqual(5, PromotesHidden(5)._member);
 }
@@ -330,41 +434,7 @@ void testPrePostInDecrementOverloading()
     Assert::AreEqual(0, (--test).getValue());
 }
 
-template <template <class, class> class V, class T>
-class CreateContainer
-{
-  protected:
-    V<T, std::allocator<T>> _container;
-
-  public:
-    CreateContainer &addValue(const T &value)
-    {
-        _container.push_back(value);
-        return *this;
-    }
-
-    CreateContainer() {}
-
-    CreateContainer(const T &value)
-    {
-        addValue(value);
-    }
-
-    CreateContainer &operator,(const T &value)
-    {
-        return addValue(value);
-    }
-
-    CreateContainer &operator()(const T &value)
-    {
-        return addValue(value);
-    }
-
-    V<T, std::allocator<T>> get() const
-    {
-        return _container;
-    }
-};
+using DidYouKnow::CreateContainer;
 
 /**
  * Demonstrates how overloading the brackets and comma operators
@@ -522,7 +592,7 @@ void testCatchAnyException()
 {
     try
     {
-        throw new std::string("badness");
+        throw std::string("badness");
     }
     catch (...)
     {
@@ -567,7 +637,7 @@ class HasFunction
  * An interesting templated approach to determining
  * whether a function exists within a class
  */
-void testTemplateChecksFunctionExists()
+constexpr void testTemplateChecksFunctionExists()
 {
     Assert::IsTrue(HasFunction<ClassWithFunction>::exists);
     Assert::IsFalse(HasFunction<ClassWithoutFunction>::exists);
@@ -758,7 +828,7 @@ struct factorial<0>
 /**
  * Provides computation from compile-time template specialisation
  */
-void testTuringCompleteTemplateMetaProgramming()
+constexpr void testTuringCompleteTemplateMetaProgramming()
 {
     assert(factorial<5>::value == 120);
 }
@@ -875,6 +945,68 @@ void testBitfieldUnion()
     Assert::AreEqual(bitFieldValue, templatedBitFieldValue);
 }
 
+/**
+ * The width of each field of a bitfield, found by filling each with ones
+ * and counting how many it kept, which needs no reinterpreting of its
+ * storage, so works in a constant expression on any compiler
+ */
+template <typename Bits>
+constexpr std::array<unsigned, 4> bitfieldWidths(const unsigned ones = ~0u)
+{
+    Bits bits{};
+    bits.p1 = ones;
+    bits.p2 = ones;
+    bits.p3 = ones;
+    bits.p4 = ones;
+
+    return {static_cast<unsigned>(std::popcount(static_cast<unsigned>(bits.p1))),
+            static_cast<unsigned>(std::popcount(static_cast<unsigned>(bits.p2))),
+            static_cast<unsigned>(std::popcount(static_cast<unsigned>(bits.p3))),
+            static_cast<unsigned>(std::popcount(static_cast<unsigned>(bits.p4)))};
+}
+
+/**
+ * The fields a bit pattern holds, from the masks and shifts the widths
+ * imply, with the first field in the lowest bits, as testBitfieldUnion
+ * shows GCC lays them out
+ */
+constexpr std::array<unsigned, 4> bitfieldFields(const unsigned pattern, const std::array<unsigned, 4> &widths)
+{
+    std::array<unsigned, 4> fields{};
+    unsigned shift = 0;
+
+    for (size_t i = 0; i < widths.size(); ++i)
+    {
+        fields[i] = (pattern >> shift) & ((1u << widths[i]) - 1);
+        shift += widths[i];
+    }
+
+    return fields;
+}
+
+/**
+ * The bit patterns in the example above follow from the masks and shifts
+ * implied by the widths of the bitfield, which the compiler can work out.
+ * The widths are read from BitField itself, so any change to it that
+ * TemplatedBitfield<2, 3, 5, 5> does not share fails the build.
+ */
+constexpr void testBitfieldMasksAtCompileTime()
+{
+    constexpr std::array<unsigned, 4> widths = bitfieldWidths<BitField>();
+    constexpr std::array<unsigned, 4> templatedWidths = bitfieldWidths<TemplatedBitfield<2, 3, 5, 5>>();
+
+    for (size_t i = 0; i < widths.size(); ++i)
+    {
+        Assert::AreEqual(templatedWidths[i], widths[i]);
+    }
+
+    const std::array<unsigned, 4> fields = bitfieldFields(0x4c, widths);
+    Assert::AreEqual(0u, fields[0]);
+    Assert::AreEqual(3u, fields[1]);
+    Assert::AreEqual(2u, fields[2]);
+    Assert::AreEqual(0u, fields[3]);
+}
+
 /**
  * Not so much a language feature, but an example of how the standard library
  * provides some handy libraries that simplify mundane tasks.
@@ -903,10 +1035,46 @@ void testStreamIterators()
         strings[2] == "file!");
 }
 
+/**
+ * Streams pay for locales, virtual calls and, with endl, a flush per line.
+ * std::from_chars and std::to_chars pay for none of them, so whole buffers
+ * of numbers can be read into columns, and written back out, directly.
+ */
+void testColumnsRoundTripWithoutStreams()
+{
+    DidYouKnow::Columns columns({DidYouKnow::ColumnType::Integer, DidYouKnow::ColumnType::Real});
+    columns.parse("12345678901234567,0.5\r\n\n-9223372036854775808,-1e-300\n7,3");
+
+    Assert::AreEqual(static_cast<size_t>(3), columns.rows());
+    Assert::AreEqual(12345678901234567LL, columns.integers(0)[0]);
+    Assert::AreEqual(std::numeric_limits<long long>::min(), columns.integers(0)[1]);
+    Assert::AreEqual(-1e-300, columns.reals(1)[1]);
+
+    std::string formatted;
+    columns.format(formatted);
+    Assert::AreEqual("12345678901234567,0.5\n-9223372036854775808,-1e-300\n7,3\n", formatted);
+
+    try
+    {
+        columns.parse("8,1.5\n9,x\n");
+        Assert::Fail();
+    }
+    catch (const std::invalid_argument &e)
+    {
+        Assert::AreEqual(std::string("Malformed column 2 on line 2"), e.what());
+        Assert::AreEqual(static_cast<size_t>(4), columns.rows());
+    }
+
+    std::vector<int> integers;
+    DidYouKnow::parseIntegers(" 1\t-22\n333 4444 ", integers);
+    Assert::AreEqual(static_cast<size_t>(4), integers.size());
+    Assert::AreEqual(333, integers[2]);
+}
+
 /**
  * Proving that classes can be declared in a for loop, err, declaration
  */
-void testUnexpectedDeclarationsInForLoop()
+constexpr void testUnexpectedDeclarationsInForLoop()
 {
     int count = 0;
 
@@ -931,6 +1099,79 @@ void testBewareMapBracketsOperator()
     Assert::AreNotEqual(stringsToStrings.find("didNotExist"), stringsToStrings.end());
 }
 
+/**
+ * A directory of its own for a test's files, made under the system's
+ * temporary directory, so a test runs from wherever main.exe is run, and
+ * removed with everything in it once the test is done
+ */
+class TemporaryDirectory
+{
+    std::string _path;
+
+  public:
+    explicit TemporaryDirectory(const std::string &name)
+        : _path((std::filesystem::temp_directory_path() / (name + ".XXXXXX")).string())
+    {
+        if (!mkdtemp(_path.data()))
+        {
+            throw std::runtime_error("Could not make a temporary directory for " + name);
+        }
+    }
+
+    TemporaryDirectory(const TemporaryDirectory &) = delete;
+    TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+    ~TemporaryDirectory()
+    {
+        std::error_code ignored;
+        std::filesystem::remove_all(_path, ignored);
+    }
+
+    std::string operator/(const std::string &file) const
+    {
+        return _path + "/" + file;
+    }
+};
+
+/**
+ * A map of strings needs no parsing at all to be read back, once written
+ * as offsets into one block of strings, since that can be mapped straight
+ * into memory, and searched where it lies
+ */
+void testMappedTableServesLookupsFromTheMapping()
+{
+    const std::map<std::string, std::string> stringsToStrings = {
+        {"", "empty key"}, {"colour", "blue"}, {"empty", ""}, {"key", "value"}, {"\xff", "high bytes sort last"}};
+    const TemporaryDirectory directory("testMappedTable");
+    const std::string path = directory / "table";
+    DidYouKnow::writeMappedTable(path, stringsToStrings);
+
+    {
+        const DidYouKnow::MappedTable table(path);
+        Assert::AreEqual(stringsToStrings.size(), table.size());
+
+        for (const auto &entry : stringsToStrings)
+        {
+            Assert::IsTrue(table.find(entry.first) == std::string_view(entry.second));
+        }
+
+        Assert::IsFalse(table.find("didNotExist").has_value());
+        Assert::AreEqual(std::string_view("value"), *table.find("key"));
+    }
+
+    std::ofstream(path.c_str()) << "not a mapped table";
+
+    try
+    {
+        const DidYouKnow::MappedTable table(path);
+        Assert::Fail();
+    }
+    catch (const std::invalid_argument &)
+    {
+        Assert::Success();
+    }
+}
+
 template <typename T>
 class TemplatedClassWithFriendFunction
 {
@@ -1019,7 +1260,7 @@ void testCompositionViaPrivateInheritance()
  * primitive types, mainly that direct initialisation isn't quite construction,
  * as it appears
  */
-void testDirectInitialisation()
+constexpr void testDirectInitialisation()
 {
     const int usualAssignment = 7;
     const int directInitialisation(7);
@@ -1114,7 +1355,7 @@ void testChangingDefaultArguments()
     Assert::AreEqual(10, ::changeMyArgumentDefault());
 }
 
-void testRangedForLoop()
+constexpr void testRangedForLoop()
 {
     auto array = {1, 2, 3, 4, 5};
     auto total = 0;
@@ -1127,23 +1368,498 @@ void testRangedForLoop()
     Assert::AreEqual(15, total);
 }
 
-int main()
+enum class ParseError
 {
-    typedef void (*testFunction)();
+    Empty,
+    NotANumber,
+    TooLarge
+};
 
-    const std::vector<testFunction> &tests =
-        CreateContainer<std::vector, testFunction>(&testBranchOnVariableDeclaration)(&testArrayIndexAccess)(&testKeywordOperatorTokens)(&testChangingScope)(&testPointerToMemberOperators)(&testMemberPointersCircumventScope)(&testScopeGuardTrick)(&testPrePostInDecrementOverloading)(&testFluentCommaAndBracketOverloads)(&testReturnOverload)(&testNamespaces)(&testTernaryAsValue)(&testBareURIViaGoto)(&testCatchAnyException)(&testTemplateChecksFunctionExists)(&testIdentityMetaFunction)(&testDecayArrayToPointerViaUnaryOperator)(&testCallSurrogateFunctions)(&testVoidReturn)(&testFindingTypeName)(&testFunctionTryBlocks)(&testTuringCompleteTemplateMetaProgramming)(&testMostVexingParse)(&testArgumentDependentLookup)(&testBitfieldUnion)(&testStreamIterators)(&testUnexpectedDeclarationsInForLoop)(&testBewareMapBracketsOperator)(&testTemplatedClassWithFriendFunctionAvoidsViolatingODR)(&testCompositionViaPrivateInheritance)(&testDirectInitialisation)
-        //(& testTemplateAsFriend)
-        (&testMutable)(&testChangingDefaultArguments)(&testRangedForLoop)
-            .get();
+DidYouKnow::Expected<int, ParseError> parseDigits(const std::string &text)
+{
+    if (text.empty())
+    {
+        return DidYouKnow::unexpected(ParseError::Empty);
+    }
 
-    const size_t &numberOfTests = tests.size();
+    int value = 0;
 
-    for (size_t i = 0; i < numberOfTests; ++i)
+    for (const char digit : text)
     {
-        tests[i]();
+        if (digit < '0' || digit > '9')
+        {
+            return DidYouKnow::unexpected(ParseError::NotANumber);
+        }
+
+        value = value * 10 + (digit - '0');
     }
 
-    std::cout << numberOfTests << " tests passed successfully!" << std::endl;
-    return EXIT_SUCCESS;
+    return value;
+}
+
+DidYouKnow::Expected<int, ParseError> atMostAHundred(const int value)
+{
+    if (value > 100)
+    {
+        return DidYouKnow::unexpected(ParseError::TooLarge);
+    }
+
+    return value;
+}
+
+/**
+ * Throwing is a costly way to handle an expected failure, as the ternary
+ * test above does.  Instead, an Expected returns either a value or an error,
+ * and chains further operations that only run while there is still a value.
+ */
+void testExpectedChainsWithoutThrowing()
+{
+    const DidYouKnow::Expected<int, ParseError> doubled =
+        parseDigits("21").andThen(atMostAHundred).transform([](const int value)
+                                                            { return value * 2; });
+
+    Assert::IsTrue(doubled.hasValue());
+    Assert::AreEqual(42, doubled.value());
+
+    Assert::IsTrue(parseDigits("oops").andThen(atMostAHundred).error() == ParseError::NotANumber);
+    Assert::IsTrue(parseDigits("101").andThen(atMostAHundred).error() == ParseError::TooLarge);
+    Assert::AreEqual(-1, parseDigits("").valueOr(-1));
+
+    Assert::AreEqual(0, parseDigits("").orElse([](const ParseError)
+                                                { return DidYouKnow::Expected<int, ParseError>(0); })
+                            .value());
+
+    static_assert(std::is_trivially_copyable<DidYouKnow::Expected<int, ParseError>>::value,
+                  "Passed around in registers, just like an error code");
+}
+
+/**
+ * Unlike a function pointer, a SmallFunction can carry captured state,
+ * and it does so without allocating, as the captures are stored inline
+ */
+void testSmallFunctionCapturesState()
+{
+    int calls = 0;
+    const DidYouKnow::SmallFunction<int(int)> addCalls = [&calls](const int value)
+    { return value + ++calls; };
+
+    Assert::AreEqual(11, addCalls(10));
+    Assert::AreEqual(12, addCalls(10));
+
+    const std::string greeting("hello");
+    const DidYouKnow::SmallFunction<std::string(const char *)> greet = [greeting](const char *name)
+    { return greeting + " " + name; };
+
+    const DidYouKnow::SmallFunction<std::string(const char *)> copied(greet);
+    Assert::AreEqual("hello world", copied("world"));
+}
+
+unsigned long long factorialAtRuntime(unsigned n)
+{
+    unsigned long long result = 1;
+
+    while (n > 1)
+    {
+        result *= n--;
+    }
+
+    return result;
+}
+
+template <size_t... N>
+std::array<std::pair<unsigned, unsigned long long>, sizeof...(N)> factorialTable(std::index_sequence<N...>)
+{
+    return {{std::make_pair(static_cast<unsigned>(N), static_cast<unsigned long long>(factorial<N>::value))...}};
+}
+
+/**
+ * Table-driven tests check many cases with a single body: here, factorials
+ * calculated at compile time are unpacked into a table via a parameter pack,
+ * then each row is compared with the same calculation made at runtime
+ */
+void testParameterisedTable()
+{
+    DidYouKnow::forEachCase(factorialTable(std::make_index_sequence<13>()),
+                            [](const std::pair<unsigned, unsigned long long> &row)
+                            { Assert::AreEqual(row.second, factorialAtRuntime(row.first)); });
+}
+
+/**
+ * Generators make each case on demand, so hundreds of thousands of them can
+ * be run without writing out a table: here, every 18-bit pattern is unpacked
+ * via the BitFieldUnion and compared with the equivalent masks and shifts
+ */
+void testParameterisedGenerator()
+{
+    DidYouKnow::forEachGenerated<unsigned>(
+        1 << 18,
+        [](const size_t i)
+        { return static_cast<unsigned>(i); },
+        [](const unsigned &bits)
+        {
+            BitFieldUnion bitFieldUnion;
+            bitFieldUnion.bitInteger = bits;
+
+            Assert::AreEqual(bits & 0x3, static_cast<unsigned>(bitFieldUnion.bitField.p1));
+            Assert::AreEqual((bits >> 2) & 0x7, static_cast<unsigned>(bitFieldUnion.bitField.p2));
+            Assert::AreEqual((bits >> 5) & 0x1f, static_cast<unsigned>(bitFieldUnion.bitField.p3));
+            Assert::AreEqual((bits >> 10) & 0x1f, static_cast<unsigned>(bitFieldUnion.bitField.p4));
+        });
+}
+
+/**
+ * A snapshot is an immutable version of the map, so it is unaffected by
+ * later changes, which are published as new versions instead.  Old versions
+ * are only deleted once no snapshot of them remains.
+ */
+void testSnapshotMapIsolatesReaders()
+{
+    DidYouKnow::SnapshotMap<std::string, std::string> configuration;
+    configuration.set("key", "value");
+
+    {
+        const DidYouKnow::SnapshotMap<std::string, std::string>::Snapshot before = configuration.snapshot();
+        configuration.set("key", "changed");
+
+        Assert::AreEqual("value", *before.find("key"));
+        Assert::IsTrue(configuration.versionsAwaitingReclamation() > 0);
+    }
+
+    Assert::AreEqual("changed", *configuration.get("key"));
+    Assert::AreEqual(static_cast<size_t>(0), configuration.versionsAwaitingReclamation());
+}
+
+/**
+ * Readers on other threads never lock, yet always see every change
+ * published together, as each update replaces the whole map at once
+ */
+void testSnapshotMapPublishesChangesTogether()
+{
+    DidYouKnow::SnapshotMap<std::string, int> configuration;
+    configuration.update([](std::map<std::string, int> &map)
+                         { map["first"] = map["second"] = 0; });
+
+    std::atomic<bool> writing(true);
+    std::vector<std::thread> readers;
+
+    for (int reader = 0; reader < 4; ++reader)
+    {
+        readers.push_back(std::thread([&]()
+                                      {
+            while (writing.load())
+            {
+                const DidYouKnow::SnapshotMap<std::string, int>::Snapshot current = configuration.snapshot();
+                Assert::AreEqual(*current.find("first"), *current.find("second"));
+            } }));
+    }
+
+    for (int i = 1; i <= 1000; ++i)
+    {
+        configuration.update([i](std::map<std::string, int> &map)
+                             { map["first"] = map["second"] = i; });
+    }
+
+    writing.store(false);
+
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+
+    Assert::AreEqual(1000, *configuration.get("second"));
+}
+
+/**
+ * An expensive piece of state, such as a large dataset, derives from Fixture
+ * via the Curiously Recurring Template Pattern (CRTP), so that it is built
+ * lazily, only once, then shared read-only with every test that declares it
+ */
+struct LargeDictionary : DidYouKnow::Fixture<LargeDictionary>
+{
+    std::map<std::string, std::string> entries;
+
+    LargeDictionary()
+    {
+        for (int i = 0; i < 20000; ++i)
+        {
+            entries["key" + std::to_string(i)] = "value" + std::to_string(i);
+        }
+    }
+};
+
+/**
+ * Tests declare the fixtures they need as constant reference parameters
+ */
+void testFixtureDeclaredAsParameter(const LargeDictionary &dictionary)
+{
+    Assert::AreEqual(20000, static_cast<int>(dictionary.entries.size()));
+    Assert::AreEqual("value42", dictionary.entries.at("key42"));
+}
+
+/**
+ * Every test is handed the very same instance, rather than a fresh copy
+ */
+void testFixtureSharedBetweenTests(const LargeDictionary &dictionary)
+{
+    Assert::AreEqual(&LargeDictionary::shared(), &dictionary);
+    Assert::IsTrue(dictionary.entries.find("didNotExist") == dictionary.entries.end());
+}
+
+DidYouKnow::Task echoOneByte(DidYouKnow::EventLoop &loop, const int fd)
+{
+    char received = 0;
+    co_await loop.readable(fd);
+    Assert::AreEqual(1L, static_cast<long>(read(fd, &received, 1)));
+    co_await loop.writable(fd);
+    Assert::AreEqual(1L, static_cast<long>(write(fd, &received, 1)));
+}
+
+/**
+ * C++20 coroutines let a test suspend while it waits on I/O, rather than
+ * blocking every other test: here, a spawned Task echoes back whatever
+ * is sent down one end of a socket pair, all on a single thread
+ */
+DidYouKnow::Task testCoroutineAwaitsSocket(DidYouKnow::EventLoop &loop)
+{
+    int sockets[2];
+    Assert::AreEqual(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    loop.spawn(echoOneByte(loop, sockets[1]));
+
+    co_await loop.writable(sockets[0]);
+    Assert::AreEqual(1L, static_cast<long>(write(sockets[0], "!", 1)));
+
+    char echoed = 0;
+    co_await loop.readable(sockets[0]);
+    Assert::AreEqual(1L, static_cast<long>(read(sockets[0], &echoed, 1)));
+    Assert::AreEqual('!', echoed);
+
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+DidYouKnow::Task sleepUntilThenCount(DidYouKnow::EventLoop &loop,
+                                     const DidYouKnow::EventLoop::Clock::time_point deadline,
+                                     int &woken)
+{
+    co_await loop.sleepUntil(deadline);
+    ++woken;
+}
+
+/**
+ * A thousand coroutines that each wait 20ms take about 20ms in total,
+ * not 20 seconds, as they are all in flight at once
+ */
+DidYouKnow::Task testThousandsOfCoroutinesInFlight(DidYouKnow::EventLoop &loop)
+{
+    typedef DidYouKnow::EventLoop::Clock Clock;
+    const Clock::time_point started = Clock::now();
+    const Clock::time_point deadline = started + std::chrono::milliseconds(20);
+    int woken = 0;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        loop.spawn(sleepUntilThenCount(loop, deadline, woken));
+    }
+
+    co_await loop.sleepUntil(deadline + std::chrono::milliseconds(1));
+
+    Assert::AreEqual(1000, woken);
+    Assert::IsTrue(Clock::now() - started < std::chrono::seconds(1));
+}
+
+/**
+ * A run given a deadline abandons whatever is still waiting when it passes,
+ * which is how the runner stops one stuck coroutine holding up the rest
+ */
+void testEventLoopAbandonsTasksAtDeadline()
+{
+    typedef DidYouKnow::EventLoop::Clock Clock;
+    DidYouKnow::EventLoop loop;
+    int woken = 0;
+
+    loop.spawn(sleepUntilThenCount(loop, Clock::now() + std::chrono::milliseconds(1), woken));
+    loop.spawn(sleepUntilThenCount(loop, Clock::now() + std::chrono::hours(1), woken));
+
+    const Clock::time_point started = Clock::now();
+    Assert::IsFalse(loop.run(started + std::chrono::milliseconds(20)));
+
+    Assert::AreEqual(1, woken);
+    Assert::IsTrue(Clock::now() - started < std::chrono::seconds(1));
+    Assert::AreEqual(static_cast<size_t>(0), loop.inFlight());
+}
+
+/**
+ * Threads reporting at once, through a queue far smaller than what they
+ * report, lose nothing, and the JUnit header counts every record
+ */
+void testReporterCollectsRecordsFromManyThreads()
+{
+    const TemporaryDirectory directory("testReporter");
+    const std::string jsonLines = directory / "report.jsonl", junit = directory / "report.xml";
+    DidYouKnow::ReportSummary summary;
+
+    {
+        DidYouKnow::Reporter reporter(jsonLines, junit, 64);
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&reporter, t]()
+                                 {
+                for (int i = 0; i < 250; ++i)
+                {
+                    reporter.report(DidYouKnow::ReportRecord{"reported \"<&>\"", i % 50 || t ? DidYouKnow::Outcome::Passed : DidYouKnow::Outcome::Failed, 1000, 1, -1});
+                } });
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        summary = reporter.close();
+    }
+
+    Assert::AreEqual(static_cast<size_t>(1000), summary.total());
+    Assert::AreEqual(static_cast<size_t>(5), summary.failed);
+
+    std::ifstream lines(jsonLines.c_str());
+    std::string line;
+    size_t count = 0;
+
+    while (std::getline(lines, line))
+    {
+        Assert::AreEqual(std::string("{\"name\":\"reported \\\"<&>\\\"\""), line.substr(0, line.find(",\"outcome\"")));
+        ++count;
+    }
+
+    Assert::AreEqual(static_cast<size_t>(1000), count);
+
+    std::ifstream xml(junit.c_str());
+    std::stringstream text;
+    text << xml.rdbuf();
+    Assert::IsTrue(text.str().find("tests=\"1000\" failures=\"5\" errors=\"0\"") != std::string::npos);
+    Assert::IsTrue(text.str().find("name=\"reported &quot;&lt;&amp;&gt;&quot;\"") != std::string::npos);
+}
+
+/**
+ * Control characters in a name are escaped in both formats, and the JUnit
+ * file is whole, counting what has been reported, before the Reporter is
+ * closed, so a run that ends early still leaves it readable
+ */
+void testReporterEscapesAndKeepsJUnitWhole()
+{
+    const TemporaryDirectory directory("testReporterEscapes");
+    const std::string jsonLines = directory / "report.jsonl", junit = directory / "report.xml";
+    DidYouKnow::Reporter reporter(jsonLines, junit);
+    reporter.report(DidYouKnow::ReportRecord{"tab\there\x01", DidYouKnow::Outcome::Failed, 1000, 1, -1});
+    std::string text;
+
+    for (int wait = 0; wait < 1000 && text.find("</testsuites>") == std::string::npos; ++wait)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::ifstream xml(junit.c_str());
+        std::stringstream read;
+        read << xml.rdbuf();
+        text = read.str();
+
+        if (text.find("tab&#x9;here&#x1;") == std::string::npos)
+        {
+            text.clear();
+        }
+    }
+
+    Assert::IsTrue(text.find("tests=\"1\" failures=\"1\"") != std::string::npos);
+    const std::string closing = "</testsuite>\n</testsuites>\n";
+    Assert::IsTrue(text.size() > closing.size() && text.compare(text.size() - closing.size(), closing.size(), closing) == 0);
+
+    std::ifstream lines(jsonLines.c_str());
+    std::string line;
+    std::getline(lines, line);
+    Assert::AreEqual(std::string("{\"name\":\"tab\\u0009here\\u0001\""), line.substr(0, line.find(",\"outcome\"")));
+
+    reporter.close();
+}
+
+/**
+ * A run that ends part way through leaves a journal from which the next
+ * one recovers, counting the test it was in as failed, so that test runs
+ * first, and the order saved can be replayed whatever the schedule says
+ */
+void testScheduleRecoversAnUnfinishedRun()
+{
+    const TemporaryDirectory directory("testSchedule");
+    const std::string path = directory / "schedule.log";
+    const std::vector<DidYouKnow::Test> tests = {NAMED_TEST(testMutable), NAMED_TEST(testSmallFunctionCapturesState), NAMED_TEST(testParameterisedTable)};
+
+    {
+        const DidYouKnow::Progress progress(DidYouKnow::Schedule::journalPath(path), 1);
+        DidYouKnow::TestResult passed(tests[0].name);
+        progress.started(passed);
+        passed.nanoseconds.push_back(1000);
+        progress.finished(passed);
+        progress.started(DidYouKnow::TestResult(tests[1].name));
+    }
+
+    DidYouKnow::Schedule schedule(path);
+    Assert::AreEqual(static_cast<size_t>(2), schedule.recover());
+    Assert::AreEqual(static_cast<size_t>(0), schedule.recover());
+
+    const std::vector<DidYouKnow::Test> ordered = DidYouKnow::Schedule(path).order(tests, 0, false);
+    Assert::AreEqual(std::string(tests[1].name), std::string(ordered[0].name));
+
+    std::vector<DidYouKnow::Test> replayed;
+    Assert::IsTrue(DidYouKnow::saveOrder({tests[2], tests[0]}, DidYouKnow::Schedule::orderPath(path)));
+    Assert::IsTrue(DidYouKnow::replayOrder(tests, DidYouKnow::Schedule::orderPath(path), replayed));
+    Assert::AreEqual(std::string(tests[2].name), std::string(replayed[0].name));
+    Assert::AreEqual(std::string(tests[0].name), std::string(replayed[1].name));
+    Assert::AreEqual(std::string(tests[1].name), std::string(replayed[2].name));
+}
+
+/**
+ * An owner taking work from one end of its range, while thieves take from
+ * the other, never hand out the same item twice, nor leave any behind
+ */
+void testWorkRangeHandsOutEachItemOnce()
+{
+    const uint32_t items = 100000;
+    DidYouKnow::WorkRange range;
+    range.assign(0, items);
+    std::vector<std::atomic<int>> taken(items);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&range, &taken, t]()
+                             {
+            uint32_t item;
+
+            while (t == 0 ? range.pop(item) : range.steal(item))
+            {
+                taken[item].fetch_add(1);
+            } });
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    Assert::IsTrue(std::all_of(taken.begin(), taken.end(), [](const std::atomic<int> &count)
+                               { return count.load() == 1; }));
+}
+
+int main(int argc, char *argv[])
+{
+    const std::vector<DidYouKnow::Test> &tests =
+        CreateContainer<std::vector, DidYouKnow::Test>(THREAD_SAFE_TEST(testBranchOnVariableDeclaration))(THREAD_SAFE_TEST(testArrayIndexAccess))(THREAD_SAFE_TEST(testAlignedBufferKernelsAgreeAtEveryLevel))(THREAD_SAFE_TEST(testKeywordOperatorTokens))(THREAD_SAFE_TEST(testPointerToMemberOperators))(THREAD_SAFE_TEST(testMemberPointersCircumventScope))(THREAD_SAFE_TEST(testScopeGuardTrick))(THREAD_SAFE_TEST(testPrePostInDecrementOverloading))(THREAD_SAFE_TEST(testFluentCommaAndBracketOverloads))(THREAD_SAFE_TEST(testReturnOverload))(THREAD_SAFE_TEST(testNamespaces))(THREAD_SAFE_TEST(testTernaryAsValue))(THREAD_SAFE_TEST(testBareURIViaGoto))(THREAD_SAFE_TEST(testCatchAnyException))(THREAD_SAFE_TEST(testIdentityMetaFunction))(THREAD_SAFE_TEST(testDecayArrayToPointerViaUnaryOperator))(THREAD_SAFE_TEST(testCallSurrogateFunctions))(THREAD_SAFE_TEST(testVoidReturn))(THREAD_SAFE_TEST(testFindingTypeName))(NAMED_TEST(testFunctionTryBlocks))(THREAD_SAFE_TEST(testMostVexingParse))(THREAD_SAFE_TEST(testArgumentDependentLookup))(THREAD_SAFE_TEST(testBitfieldUnion))(THREAD_SAFE_TEST(testStreamIterators))(THREAD_SAFE_TEST(testColumnsRoundTripWithoutStreams))(THREAD_SAFE_TEST(testBewareMapBracketsOperator))(NAMED_TEST(testMappedTableServesLookupsFromTheMapping))(THREAD_SAFE_TEST(testTemplatedClassWithFriendFunctionAvoidsViolatingODR))(THREAD_SAFE_TEST(testCompositionViaPrivateInheritance))
+        //(NAMED_TEST(testTemplateAsFriend))
+        (THREAD_SAFE_TEST(testMutable))(THREAD_SAFE_TEST(testChangingDefaultArguments))(THREAD_SAFE_TEST(testFixtureDeclaredAsParameter))(THREAD_SAFE_TEST(testFixtureSharedBetweenTests))(THREAD_SAFE_TEST(testSmallFunctionCapturesState))(NAMED_TEST(testParameterisedTable))(NAMED_TEST(testParameterisedGenerator))(THREAD_SAFE_TEST(testExpectedChainsWithoutThrowing))(NAMED_TEST(testSnapshotMapIsolatesReaders))(NAMED_TEST(testSnapshotMapPublishesChangesTogether))(NAMED_TEST(testCoroutineAwaitsSocket))(NAMED_TEST(testThousandsOfCoroutinesInFlight))(NAMED_TEST(testEventLoopAbandonsTasksAtDeadline))(NAMED_TEST(testReporterCollectsRecordsFromManyThreads))(NAMED_TEST(testReporterEscapesAndKeepsJUnitWhole))(NAMED_TEST(testScheduleRecoversAnUnfinishedRun))(NAMED_TEST(testWorkRangeHandsOutEachItemOnce))
+            .get();
+
+    const std::vector<const char *> &compileTimeTests =
+        CreateContainer<std::vector, const char *>(CONSTEXPR_TEST(testChangingScope))(CONSTEXPR_TEST(testTemplateChecksFunctionExists))(CONSTEXPR_TEST(testTuringCompleteTemplateMetaProgramming))(CONSTEXPR_TEST(testBitfieldMasksAtCompileTime))(CONSTEXPR_TEST(testUnexpectedDeclarationsInForLoop))(CONSTEXPR_TEST(testDirectInitialisation))(CONSTEXPR_TEST(testRangedForLoop))
+            .get();
+
+    return DidYouKnow::run(tests, compileTimeTests, argc, argv);
 }
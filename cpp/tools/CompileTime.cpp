@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "DidYouKnow/Benchmark.hpp"
+#include "DidYouKnow/History.hpp"
+
+/**
+ * Summarises the traces clang writes with -ftime-trace, one per translation
+ * unit: where the compiler spent its time, and which templates cost the
+ * most to instantiate, comparing each against its recorded history.
+ * Instantiation times are inclusive, so nested instantiations count towards
+ * every template that caused them.
+ */
+
+/**
+ * The string and number fields of one trace event, including those nested
+ * within its args, which is all that is needed from the trace
+ */
+typedef std::map<std::string, std::string> TraceEvent;
+
+/**
+ * Just enough of a JSON parser for Chrome trace files, flattening every
+ * object into its fields, and collecting the objects within traceEvents
+ */
+class TraceParser
+{
+    const std::string &_text;
+    size_t _position;
+
+    void skipWhitespace()
+    {
+        while (_position < _text.size() && std::isspace(static_cast<unsigned char>(_text[_position])))
+        {
+            ++_position;
+        }
+    }
+
+    std::string parseString()
+    {
+        std::string parsed;
+
+        for (++_position; _position < _text.size() && _text[_position] != '"'; ++_position)
+        {
+            if (_text[_position] == '\\' && ++_position < _text.size())
+            {
+                const char escaped = _text[_position];
+                parsed += escaped == 'n' ? '\n' : escaped == 't' ? '\t'
+                                                                 : escaped;
+                _position += escaped == 'u' ? 4 : 0;
+                continue;
+            }
+
+            parsed += _text[_position];
+        }
+
+        ++_position;
+        return parsed;
+    }
+
+    std::string parseValue(TraceEvent &fields, std::vector<TraceEvent> &events, const bool inEvents)
+    {
+        skipWhitespace();
+
+        if (_position >= _text.size())
+        {
+            return "";
+        }
+
+        if (_text[_position] == '"')
+        {
+            return parseString();
+        }
+
+        if (_text[_position] == '{')
+        {
+            TraceEvent nested;
+            TraceEvent &target = inEvents ? nested : fields;
+            ++_position;
+
+            for (skipWhitespace(); _position < _text.size() && _text[_position] != '}'; skipWhitespace())
+            {
+                const std::string key = parseString();
+                skipWhitespace();
+                ++_position;
+                const std::string value = parseValue(target, events, key == "traceEvents");
+
+                if (!value.empty())
+                {
+                    target.emplace(key, value);
+                }
+
+                skipWhitespace();
+                _position += _text[_position] == ',' ? 1 : 0;
+            }
+
+            ++_position;
+
+            if (inEvents)
+            {
+                events.push_back(nested);
+            }
+
+            return "";
+        }
+
+        if (_text[_position] == '[')
+        {
+            ++_position;
+
+            for (skipWhitespace(); _position < _text.size() && _text[_position] != ']'; skipWhitespace())
+            {
+                parseValue(fields, events, inEvents);
+                skipWhitespace();
+                _position += _text[_position] == ',' ? 1 : 0;
+            }
+
+            ++_position;
+            return "";
+        }
+
+        const size_t start = _position;
+
+        while (_position < _text.size() && !std::strchr(",}] \t\r\n", _text[_position]))
+        {
+            ++_position;
+        }
+
+        return _text.substr(start, _position - start);
+    }
+
+  public:
+    explicit TraceParser(const std::string &text) : _text(text), _position(0) {}
+
+    std::vector<TraceEvent> events()
+    {
+        TraceEvent root;
+        std::vector<TraceEvent> events;
+        parseValue(root, events, false);
+        return events;
+    }
+};
+
+/**
+ * The template a detail such as "Foo<int>::bar" was instantiated from,
+ * without spaces, so it can be recorded as a single field
+ */
+std::string templateOf(const std::string &detail)
+{
+    std::string name = detail.substr(0, detail.find('<'));
+    std::replace(name.begin(), name.end(), ' ', '_');
+    return name;
+}
+
+struct Cost
+{
+    double microseconds = 0;
+    size_t count = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    const size_t top = std::stoul(DidYouKnow::benchmarkOption(argc, argv, "--top", "10"));
+    const DidYouKnow::History history(DidYouKnow::benchmarkOption(argc, argv, "--history", "build/compile-time.log"));
+    const std::map<std::string, std::vector<double>> baseline = history.baseline(20);
+    std::vector<DidYouKnow::TestResult> results;
+
+    DidYouKnow::BenchmarkTable table({"trace", "spent on"}, {"ms", "count", "median ms", "change %"});
+
+    const auto add = [&](const std::string &trace, const std::string &what, const Cost &cost)
+    {
+        const std::string key = trace + ':' + what;
+        const auto before = baseline.find(key);
+        const double beforeMilliseconds = before == baseline.end() ? 0 : DidYouKnow::median(before->second) / 1e6;
+        const double milliseconds = cost.microseconds / 1e3;
+
+        table.add({trace, what}, {milliseconds, static_cast<double>(cost.count), beforeMilliseconds,
+                                  beforeMilliseconds ? 100 * (milliseconds / beforeMilliseconds - 1) : 0});
+
+        DidYouKnow::TestResult result(key);
+        result.nanoseconds.push_back(cost.microseconds * 1e3);
+        result.instructions = static_cast<long long>(cost.count);
+        results.push_back(result);
+    };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string path(argv[i]);
+
+        if (path.rfind("--", 0) == 0)
+        {
+            ++i;
+            continue;
+        }
+
+        std::ifstream file(path.c_str());
+        std::stringstream text;
+        text << file.rdbuf();
+
+        if (!file)
+        {
+            std::cerr << "Could not read " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const std::string trace = path.substr(path.find_last_of('/') + 1);
+        std::map<std::string, Cost> phases, templates;
+
+        for (const TraceEvent &event : TraceParser(text.str()).events())
+        {
+            const auto name = event.find("name");
+            const auto duration = event.find("dur");
+
+            if (name == event.end() || duration == event.end())
+            {
+                continue;
+            }
+
+            const double microseconds = std::atof(duration->second.c_str());
+
+            if (name->second.rfind("Total ", 0) == 0)
+            {
+                Cost &phase = phases[name->second.substr(6)];
+                phase.microseconds += microseconds;
+                ++phase.count;
+            }
+            else if (name->second == "InstantiateClass" || name->second == "InstantiateFunction")
+            {
+                const auto detail = event.find("detail");
+                Cost &instantiated = templates[templateOf(detail == event.end() ? name->second : detail->second)];
+                instantiated.microseconds += microseconds;
+                ++instantiated.count;
+            }
+        }
+
+        for (const char *phase : {"ExecuteCompiler", "Frontend", "Backend", "InstantiateClass", "InstantiateFunction"})
+        {
+            if (phases.count(phase))
+            {
+                add(trace, phase, phases[phase]);
+            }
+        }
+
+        std::vector<std::pair<std::string, Cost>> costliest(templates.begin(), templates.end());
+        std::sort(costliest.begin(), costliest.end(), [](const auto &left, const auto &right)
+                  { return left.second.microseconds > right.second.microseconds; });
+
+        for (size_t j = 0; j < std::min(top, costliest.size()); ++j)
+        {
+            add(trace, costliest[j].first, costliest[j].second);
+        }
+    }
+
+    if (results.empty())
+    {
+        std::cerr << "Usage: CompileTime.exe <trace.json>... [--top <n>] [--history <path>] [--csv <path>]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const unsigned long long run = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       std::chrono::system_clock::now().time_since_epoch())
+                                       .count();
+
+    if (!history.append(run, results))
+    {
+        std::cerr << "Could not record compile times to " << history.path() << std::endl;
+    }
+
+    const std::string csv = DidYouKnow::benchmarkOption(argc, argv, "--csv");
+    return csv.empty() || table.writeCsv(csv) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "DidYouKnow/Benchmark.hpp"
+
+/**
+ * Writes a synthetic suite of as many tests as asked for, each of the same
+ * cost profile, registered as main.cpp registers its own, through chains of
+ * CreateContainer calls, so that compiling and running it shows how both
+ * scale to suites far larger than this one.  A single chain of a million
+ * calls is beyond any compiler, so the chain is broken into statements of
+ * --chain tests each, whose length can be varied to see where it starts to
+ * cost.
+ */
+
+const char *bodyFor(const std::string &profile)
+{
+    if (profile == "empty")
+    {
+        return "";
+    }
+
+    if (profile == "cpu")
+    {
+        return "    unsigned value = 1;\n"
+               "\n"
+               "    for (int i = 0; i < 200; ++i)\n"
+               "    {\n"
+               "        value = value * 2654435761u + 1;\n"
+               "    }\n"
+               "\n"
+               "    DidYouKnow::doNotOptimise(value);\n";
+    }
+
+    if (profile == "allocating")
+    {
+        return "    std::vector<std::string> strings(16, std::string(40, 'x'));\n"
+               "    DidYouKnow::doNotOptimise(strings);\n";
+    }
+
+    if (profile == "sleeping")
+    {
+        return "    std::this_thread::sleep_for(std::chrono::microseconds(100));\n";
+    }
+
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    const size_t tests = std::strtoull(DidYouKnow::benchmarkOption(argc, argv, "--tests", "10000").c_str(), nullptr, 10);
+    const size_t chain = std::strtoull(DidYouKnow::benchmarkOption(argc, argv, "--chain", "1000").c_str(), nullptr, 10);
+    const std::string profile = DidYouKnow::benchmarkOption(argc, argv, "--profile", "empty");
+    const std::string path = DidYouKnow::benchmarkOption(argc, argv, "--output", "build/Synthetic.cpp");
+    const char *body = bodyFor(profile);
+
+    if (!body || chain == 0)
+    {
+        std::cerr << "Usage: GenerateSuite.exe [--tests <n>] [--profile empty|cpu|allocating|sleeping] [--chain <n>] [--output <path>]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(path);
+    out << "// Generated by tools/GenerateSuite.cpp: " << tests << " " << profile << " tests\n"
+        << "#include <chrono>\n"
+           "#include <string>\n"
+           "#include <thread>\n"
+           "#include <vector>\n"
+           "\n"
+           "#include \"DidYouKnow/Benchmark.hpp\"\n"
+           "#include \"DidYouKnow/CreateContainer.hpp\"\n"
+           "#include \"DidYouKnow/Runner.hpp\"\n";
+
+    for (size_t i = 0; i < tests; ++i)
+    {
+        out << "\nvoid test" << i << "()\n{\n"
+            << body << "}\n";
+    }
+
+    out << "\nint main(int argc, char *argv[])\n"
+           "{\n"
+           "    DidYouKnow::CreateContainer<std::vector, DidYouKnow::Test> tests;\n";
+
+    for (size_t i = 0; i < tests; i += chain)
+    {
+        out << "    tests";
+
+        for (size_t j = i; j < tests && j < i + chain; ++j)
+        {
+            out << "(THREAD_SAFE_TEST(test" << j << "))";
+        }
+
+        out << ";\n";
+    }
+
+    out << "\n    return DidYouKnow::run(tests.get(), {}, argc, argv);\n"
+           "}\n";
+
+    if (!out.flush())
+    {
+        std::cerr << "Could not write " << path << std::endl;
+        return 1;
+    }
+
+    return 0;
+}